@@ -36,6 +36,7 @@
 #ifndef ALGORITHM_H
 #define ALGORITHM_H
 
+#include <omp.h>
 #include <stdio.h>   /* gets */
 #include <stdlib.h>  /* atoi, malloc */
 #include <string.h>  /* strcpy */
@@ -44,13 +45,14 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <inttypes.h>
-#include <gsl/gsl_rng.h>
 #include <assert.h>
-#include "uthash/src/uthash.h"
 #include "compileTimeOptions.h"
 #include "utils.h"
+#include "uthash/src/uthash.h"
 #include "timer.h"
 #include "argParser.h"
+#include "simdModule.h"
+#include "rngModule.h"
 
 // Static information about the graph provided by the user
 // This values do not change throughout the LAP solving steps
@@ -70,8 +72,23 @@ typedef struct graphInfo {
   ulint coocSum;
   uint nRelevantPairs;
 
+  // Compact index of the relevant pairs (see buildRelevantPairsIndex())
+  // The relevant pairs of row r of the co-occurrence half matrix are
+  //  relevantPairsCols[ relevantPairsRowStart[r] : relevantPairsRowStart[r+1] ]
+  //  and their position in this range is their relevantPairId
+  uint* relevantPairsRowStart;
+  uint* relevantPairsCols;
+
   uint* eventDegrees;
   uint* actorDegrees;
+  // Largest of each degree sequence, which bound the scratch memory of the
+  //  swaps (see curveballArenaSize())
+  uint maxEventDegree;
+  uint maxActorDegree;
+  // Checksums of both degree sequences: the sum over the edges of their
+  //  mixed event (actor) ID (see checkGraphInvariants())
+  ulint eventDegreesChecksum;
+  ulint actorDegreesChecksum;
 }GRAPHINFO;
 // Since it is static* and used in a good portion of the functions,
 // it is currently globally declared
@@ -79,12 +96,34 @@ typedef struct graphInfo {
 //  and therefore does not change it's value until the end of the program.
 GRAPHINFO graphInfo;
 
+// Hash set of the (actor, event) edges, by open addressing with linear
+//  probing, which replaces the adj. matrix in the single switches when its
+//  nEvents x nActors bits would not fit (see "-edgelookup")
+// Keys are (actorId << 32) | eventId, and at least half of the power of two
+//  slots are kept empty, so that probes stay short and always end
+// Removals shift the following keys of the probe back, leaving no tombstones
+typedef struct edgeSet {
+  uint64_t* keys;
+  uint      slotShift; // 64 - log2(nSlots), see edgeSetSlot()
+  size_t    slotMask;  // nSlots - 1
+  size_t    nKeys;
+}EDGESET;
+
+#define EDGE_SET_EMPTY_KEY UINT64_MAX
+
 // Graph structure itself, containing:
-//  A binary adjacency matrix;
+//  A binary adjacency matrix, or a hash set of the edges (see EDGESET);
 //  A vector of adjacency lists;
 //  An edge map, linking the edge index to it's actor;
 //  An edge link vector, linking to edges that are actually the same (used for non-bipartite graphs);
-//  TODO: EXPLAIN SUB BLOCKS
+//  The start and end (edge) indexes of each sub-block of each actor adj. list
+//   (see COOCSCHEDULE)
+//  Event-major adjacency lists (transposed actor lists), with the index of each
+//   edge in the actor lists. Only allocated for the engines that need them,
+//   and rebuilt from the actor lists before each use, unless they are traded
+//   themselves (event-side curveball)
+//  Its own co-occurrence half matrix, kept up to date by the curveball trades
+//   (incremental co-occurrence mode only, see threadInitIncrementalCooc())
 typedef struct graph {
   // The adj. matrix was chosen to be
   //  an unidimensional vector instead of a real matrix
@@ -92,6 +131,8 @@ typedef struct graph {
   // For code understandability, and even performance,
   //  a matrix (2D) design could be a better choise.
   BLOCK*   adjMatrix;
+  EDGESET  edgeSet;
+  BLOCK*   swapClaims; // Global single switches only
 
   uint*   actorAdjLists;
   uint*   actorAccumulatedDegrees;
@@ -101,18 +142,126 @@ typedef struct graph {
   int**     subBlocksStartIndexes;
   int**     subBlocksEndIndexes;
 
+  uint*   eventAdjLists;
+  uint*   eventEdgeIndexes;
+  uint*   eventAccumulatedDegrees;
+  uint*   eventListsFill; // Next free position of each event list
+
+  uint**  cooc;
+
+  // Whether every actor list is known to be in ascending order, which is
+  //  kept by the sorted curveball kernel (see setIndexesOfSubBlocks())
+  bool    sortedActorAdjLists;
+  // The same for the event lists, traded by the event-side curveball
+  bool    sortedEventAdjLists;
+  // Whether the event lists and their edge indexes match the actor lists,
+  //  so that they need no transposition (event-side curveball only, see
+  //  actorAdjListsFromEventAdjLists())
+  bool    currentEventAdjLists;
+  // Whether event-side trades left the actor lists behind the event lists,
+  //  when nothing reads them before the next trades (see
+  //  needsActorAdjListsAfterTrades())
+  bool    staleActorAdjLists;
+
+  // Swap steps run on the graph, which schedule its full graph test (see
+  //  graphTestStep())
+  ulint   nSwapSteps;
+  // Degree sequence checksums of the lists, kept by the trades from the
+  //  entries they rewrite (see checkGraphInvariants())
+  ulint   eventDegreesChecksum;
+  ulint   actorDegreesChecksum;
+
 }GRAPH;
 
+// Scratch arena of each thread, from which the trades, the swap heuristic
+//  and the input readers take their temporary arrays
+// Reserved after reading the input for the largest actor pair of a trade
+//  (see curveballArenaSize())
+// Only the one of the master thread exists while reading, since the number
+//  of threads depends on the graph size (see threadAllocScratch())
+SCRATCHARENA* scratchArena;
+
+// Scratch of the curveball kernels, preallocated so that trades do not
+//  allocate memory (see curveballTradeStampedLists())
+// An event is marked when its stamp equals the current epoch, so the stamps
+//  do not need to be cleared between trades
+// The pool arrays of each trade come from @arena and are released after it
+typedef struct tradeScratch {
+  uint*         eventStamps;
+  uint          stampEpoch;
+  SCRATCHARENA* arena;
+  // Change of the degree checksum of the IDs moved by the current trade
+  ulint         checksumDelta;
+}TRADESCRATCH;
+// One per thread, since the trades of a global curveball round share a graph
+TRADESCRATCH* tradeScratch;
+
+// Dense co-occurrence row of each thread of the sparse product engine, left
+//  zeroed by every row (see computeCoocRow()), so it is allocated once
+// As many as threads in any co-occurrence region (see threadAllocScratch())
+uint** coocAccumulators;
+uint   nCoocAccumulators;
+// Actor pairs with at least tradeStampMinLength events in both lists have
+//  their common events marked by event stamps instead of the set
+//  intersection kernel (adaptive curveball kernel only)
+// Set by calibrateTradeKernels()
+uint tradeStampMinLength;
+
+// Distribution of the co-occurrence computation among threads
+// The events are split into nSubBlocks ranges of contiguous IDs.
+// Every combination of two sub-blocks (i <= j) is a tile, that is,
+//  a region of the co-occurrence half matrix which no other tile writes to.
+// Therefore, any tile can be computed by any thread without synchronization,
+//  and the tiles are balanced among threads according to their costs
+//  (#pairs of edges of the actors falling into the tile).
+typedef struct coocSchedule {
+  uint  nSubBlocks;
+  uint  nTiles;
+  uint  nThreads;
+
+  uint*  tileSubBlocks1;
+  uint*  tileSubBlocks2;
+  // Expected cost of each tile, given the node degrees, and the tiles from the
+  //  most to the least expensive, in which order any team deals them
+  //  dynamically (see orderCoocTiles())
+  // Read-only once set, so that co-occurrences can be computed concurrently
+  double* tileCosts;
+  uint*   tileOrder;
+
+  // Heavy actors, whose pairs alone would outweigh a tile, are skipped by the
+  //  tiles. Their pairs are then split into bands of rows (the events
+  //  heavyBandsStart[b] : heavyBandsStart[b+1]), dealt dynamically
+  // Depends only on the node degrees, so it is set once (see
+  //  initHeavyActorsSchedule())
+  uint   nHeavyActors;
+  uint*  heavyActors;
+  bool*  isHeavyActor;
+  uint   nHeavyBands;
+  uint*  heavyBandsStart;
+}COOCSCHEDULE;
+// Depends only on the number of threads, so it is globally declared as well
+COOCSCHEDULE coocSchedule;
+
 // Structure that contain all important variables to caclculate the final result
-// These temporary results refer to all possible pairs of nodes of interest
-// Not only the ones which the original co-occurrence is higher than zero
+// The last co-occurrence refers to all possible pairs of nodes of interest,
+//  since it is written by the co-occurrence engines (NULL in fused
+//  statistics mode, see threadUpdateTmpResultFused()),
+//  while the statistics refer only to the relevant pairs,
+//  indexed by their relevantPairId (see GRAPHINFO)
 typedef struct tmpresult {
   uint** lastCooc;
 
-  uint** pValue;
+  uint* pValue;
 
-  ulint** coocSum;
-  ulint** coocSquareSum;
+  ulint* coocSum;
+  ulint* coocSquareSum;
+
+  // Narrow co-occurrences of the relevant pairs of every graph of the round
+  //  (graph-major, nRelevantPairs per graph) and of the original graph,
+  //  folded into the statistics once per round (see foldStatisticsBatch)
+  // NULL when some co-occurrence may not fit (see tmpResultInitialize())
+  uint16_t* roundCooc;
+  uint16_t* originalNarrowCooc;
   
 }TMPRESULT;
 
@@ -136,7 +285,7 @@ typedef struct __attribute__((packed)) pair {
 
 struct timespec randSorterSeed;
 
-gsl_rng *randC;
+RANDGEN *randC;
 
 /* **************************************** */
 /* Sorting related functions */
@@ -148,8 +297,8 @@ PAIR qselect(PAIR *v, uint len, uint k);
 
 /* **************************************** */
 /* Shuffle related functions */
-void shuffle(unsigned *array, size_t n, gsl_rng* thisRandG);
-void shufflePartial(unsigned *array, size_t n, gsl_rng* thisRandG, uint nEvents);
+void shuffle(unsigned *array, size_t n, RANDGEN* thisRandG);
+void shufflePartial(unsigned *array, size_t n, RANDGEN* thisRandG, uint nEvents);
 /* **************************************** */
 
 /* **************************************** */
@@ -157,36 +306,156 @@ void shufflePartial(unsigned *array, size_t n, gsl_rng* thisRandG, uint nEvents)
 void singleSwapBipartite (GRAPH* g, uint* edgeIds);
 
 void singleSwapGeneral (GRAPH* g, uint* edgeIds);
-void singleSwapParallel (GRAPH* g, uint* edgeIds);
+
+// Concurrent single switches on one graph (see "-globalsingleswitch"): a
+//  switch owns the list entries of its two edges by setting their lock bit,
+//  which event IDs never have, and its new edges by their claim bits (see
+//  swapClaims), so that the adj. matrix holds real edges only. A switch
+//  that finds any of them taken is given up, and returns FALSE
+#define SWAP_ENTRY_LOCK_BIT 0x80000000u
+size_t nSwapClaimBlocks();
+bool trySingleSwapParallel (GRAPH* g, uint* edgeIds);
+
+EDGELOOKUP autoSelectEdgeLookup();
+size_t edgeSetSlots(size_t nKeys);
+bool allocEdgeSet(EDGESET* edgeSet, size_t nKeys);
+void deleteEdgeSet(EDGESET* edgeSet);
+void clearEdgeSet(EDGESET* edgeSet);
+bool edgeSetContains(const EDGESET* edgeSet, uint actorId, uint eventId);
+void edgeSetInsert(EDGESET* edgeSet, uint actorId, uint eventId);
+void edgeSetRemove(EDGESET* edgeSet, uint actorId, uint eventId);
+bool edgeSetFromAdjLists(GRAPH* g);
+
+static inline uint64_t edgeSetKey(uint actorId, uint eventId)
+{
+  return ( (uint64_t) actorId << 32 ) | eventId;
+}
+
+// Fibonacci hashing: the high bits of the product spread the nearby IDs
+static inline size_t edgeSetSlot(const EDGESET* edgeSet, uint64_t key)
+{
+  return (size_t) ( ( key * 0x9E3779B97F4A7C15ULL ) >> edgeSet->slotShift );
+}
+
+// Software pipeline of the single switch loops (see
+//  threadRunSingleSwitchesBipartite()): the list entries of a switch are
+//  prefetched when its edges are drawn, SINGLE_SWITCH_PIPELINE_DEPTH switches
+//  ahead, and its adj. matrix words (or edge set slots) half as many switches
+//  ahead
+static inline void prefetchSwapEdges(const GRAPH* g, const uint* edgeIds)
+{
+  for (uint edgeIt = 0; edgeIt < 2; ++edgeIt) {
+    __builtin_prefetch( &g->actorAdjLists[ edgeIds[edgeIt] ] );
+    __builtin_prefetch( &g->actorEdgeMaps[ edgeIds[edgeIt] ] );
+    if ( !settings.isBipartiteGraph ) {
+      __builtin_prefetch( &g->edgeLinks[ edgeIds[edgeIt] ] );
+    }
+  }
+}
+
+static inline void prefetchSwapLookups(const GRAPH* g, const uint* edgeIds)
+{
+  // The switches resolved in between may still move these events: the
+  //  prefetch is only a hint, and the switch reads its edges again
+  const uint eventIds[2] = { g->actorAdjLists[ edgeIds[0] ],
+                             g->actorAdjLists[ edgeIds[1] ] };
+  const uint actorIds[2] = { g->actorEdgeMaps[ edgeIds[0] ],
+                             g->actorEdgeMaps[ edgeIds[1] ] };
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    for (uint eventIt = 0; eventIt < 2; ++eventIt) {
+      for (uint actorIt = 0; actorIt < 2; ++actorIt) {
+        __builtin_prefetch( &g->edgeSet.keys[ edgeSetSlot( &g->edgeSet,
+              edgeSetKey(actorIds[actorIt], eventIds[eventIt]) ) ] );
+        if ( !settings.isBipartiteGraph ) { // Redundant edges
+          __builtin_prefetch( &g->edgeSet.keys[ edgeSetSlot( &g->edgeSet,
+                edgeSetKey(eventIds[eventIt], actorIds[actorIt]) ) ] );
+        }
+      }
+    }
+    return;
+  }
+  for (uint eventIt = 0; eventIt < 2; ++eventIt) {
+    for (uint actorIt = 0; actorIt < 2; ++actorIt) {
+      __builtin_prefetch( &g->adjMatrix[
+                            eventIds[eventIt] * graphInfo.nBlocksPerEvent
+                            + actorIds[actorIt] / BITS_PER_BLOCK ] );
+      if ( !settings.isBipartiteGraph ) { // Redundant edges
+        __builtin_prefetch( &g->adjMatrix[
+                              actorIds[actorIt] * graphInfo.nBlocksPerEvent
+                              + eventIds[eventIt] / BITS_PER_BLOCK ] );
+      }
+    }
+  }
+}
 /* **************************************** */
 
 /* **************************************** */
 /* Curveball randomization related functions and structs */
-bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG);
+bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                               TRADESCRATCH* scratch);
 
 typedef struct __attribute__((packed)) pool_hash_table {
     uint32_t listIndex;
     uint eventId;
     UT_hash_handle hh;         /* makes this structure hashable */
 }POOL_HASH;
-POOL_HASH* addEventToPool(POOL_HASH* poolHash, uint idx, uint eventId);
-bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG);
+POOL_HASH* addEventToPool(POOL_HASH* poolHash, POOL_HASH* newItem,
+                          uint idx, uint eventId);
+bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                               TRADESCRATCH* scratch);
+bool curveballTradeStampedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                                TRADESCRATCH* scratch);
+bool curveballTrade(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                    TRADESCRATCH* scratch);
+bool isSortedCurveballKernel();
+bool isEventSideCurveball();
+uint nTradeLists();
+uint nTradeListIds();
+uint maxTradeListLength();
+CURVEBALLSIDE autoSelectCurveballSide();
+void buildEventAdjLists(GRAPH* g);
+bool actorAdjListsFromEventAdjLists(GRAPH* g, SCRATCHARENA* arena);
+bool needsActorAdjListsAfterTrades();
+bool needsAdjMatrixAfterTrades();
+bool calibrateTradeKernels(TRADESCRATCH* scratch);
+void coocReplaceListEntry(uint** cooc, uint* list, uint length,
+                          uint position, uint newEventId);
 /* **************************************** */
 
 /* **************************************** */
 /* Edge pairs' co-occurrence assessing functions */
+bool initCoocSchedule(COOCSCHEDULE* schedule, uint nThreads);
+void deleteCoocSchedule(COOCSCHEDULE* schedule);
+bool initHeavyActorsSchedule(COOCSCHEDULE* schedule);
+void orderCoocTiles(COOCSCHEDULE* schedule);
+
+void sortActorAdjList(GRAPH* g, uint actorId);
 void setIndexesOfSubBlocks (GRAPH* g, uint actorId);
-void computeCooc(GRAPH* g, uint** cooc, int threadId); 
+void computeCoocTile(GRAPH* g, uint** cooc, uint tileId);
+void computeCoocHeavyBand(GRAPH* g, uint** cooc, uint bandId);
 
 void computeDirectEdgeCooc(GRAPH* g, uint actorId, uint** cooc);
 
+void setEventAccumulatedDegrees(GRAPH* g);
+void transposeActorAdjList(GRAPH* g, uint actorId);
+void accumulateCoocRow(GRAPH* g, uint eventId, uint* accumulator);
+void computeCoocRow(GRAPH* g, uint** cooc, uint eventId, uint* accumulator);
+
+void computeCoocBitMatrixRows(GRAPH* g, uint** cooc, uint firstEventId);
+COOCENGINE autoSelectCoocEngine();
+
 uint eventPairCoocCalc (GRAPH* g, uint event1, uint event2);
 /* **************************************** */
 
 void resultList(PAIR* pairs, TMPRESULT* tmpResult,
                    uint nEvents, uint nSamples);
 
-bool coocHalfMatricesInitialize(TMPRESULT* tmpResult, uint nEvents);
+ulint foldCoocRowStatistics(TMPRESULT* tmpResult, uint eventId,
+                            uint* accumulator, uint graphIt);
+void foldRoundStatistics(TMPRESULT* tmpResult,
+                         uint firstRelevantPairId, uint nRelevantPairs);
+bool hasNarrowRoundCooc();
+bool tmpResultInitialize(TMPRESULT* tmpResult, uint nEvents);
 
 
 /* **************************************** */
@@ -198,17 +467,26 @@ bool allocGraphInfo(GRAPHINFO* gInfo);
 bool copyGraphInfoValues(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo);
 bool copyGraphInfoArrays(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo);
 bool copyGraphInfo(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo);
+bool buildRelevantPairsIndex(GRAPHINFO* gInfo);
 bool areEqualGraphInfos(GRAPHINFO* gInfo1, GRAPHINFO* gInfo2);
 void deleteGraphInfoArrays(GRAPHINFO* gInfo);
 void deleteGraphInfo(GRAPHINFO* gInfo);
 
 void initGraph(GRAPH* g);
 bool allocGraph(GRAPH* g);
+bool needsEventAdjLists();
+bool allocEventAdjLists(GRAPH* g);
+size_t graphReplicaBytes();
+size_t threadScratchBytes();
+bool needsTradeScratch();
 bool copyGraphData(GRAPH* g, GRAPH* baseG);
 bool copyGraph(GRAPH* g, GRAPH* baseG);
 bool canonizeGraph(GRAPH* g);
 bool areEqualGraphs(GRAPH* g1, GRAPH* g2);
 void deleteGraph(GRAPH* g);
+size_t curveballArenaSize();
+bool allocTradeScratch(TRADESCRATCH* scratch, SCRATCHARENA* arena);
+void deleteTradeScratch(TRADESCRATCH* scratch);
 
 bool adjMatrixFromAdjLists(GRAPH* g);
 bool adjListsFromAdjMatrix(GRAPH* g);
@@ -235,7 +513,10 @@ bool checkAdjListUniqueEvent(GRAPH* g);
 bool checkAdjListSort(GRAPH* g);
 bool checkAdjStructs(GRAPH* g);
 bool checkEdgeLinks(GRAPH* g);
+bool checkGraphInvariants(GRAPH* g);
 bool graphTest(GRAPH* g);
+bool isFullGraphTestStep(GRAPH* g);
+bool graphTestStep(GRAPH* g);
 /* **************************************** */
 
 #endif
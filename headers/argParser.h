@@ -43,6 +43,44 @@
 #include "utils.h"
 #include "timer.h"
 
+// Co-occurrence computation engines
+typedef enum coocEngine {
+  COOC_ENGINE_SUBBLOCKS, // Actor lists expanded into pairs, by sub-block tiles
+  COOC_ENGINE_SPGEMM,    // Row-by-row sparse product B.B^T (event-major CSR)
+  COOC_ENGINE_BITMATRIX, // All-pairs AND+popcount over the adj. matrix rows
+  COOC_ENGINE_AUTO       // Sub-blocks or bit matrix, by the graph density
+}COOCENGINE;
+
+// Curveball trade kernels
+typedef enum curveballKernel {
+  CURVEBALL_KERNEL_HASHED, // Hashed pool, lists refilled in place (unsorted)
+  CURVEBALL_KERNEL_SORTED, // Merged pool, lists refilled in ascending order
+  CURVEBALL_KERNEL_STAMPED, // Pool from per-thread event stamps, no allocation
+  CURVEBALL_KERNEL_ADAPTIVE // As sorted, pool built per actor pair by merge,
+                            //  galloping or event stamps (calibrated)
+}CURVEBALLKERNEL;
+
+// Side whose adjacency lists are traded by the curveball
+typedef enum curveballSide {
+  CURVEBALL_SIDE_ACTORS, // Actor lists (actor-major CSR)
+  CURVEBALL_SIDE_EVENTS, // Event lists (event-major CSR)
+  CURVEBALL_SIDE_AUTO    // The side with fewer nodes, i.e. longer lists
+}CURVEBALLSIDE;
+
+// Structures answering the edge queries of the single switches
+typedef enum edgeLookup {
+  EDGE_LOOKUP_MATRIX, // Adjacency bit matrix, one bit per (event, actor) pair
+  EDGE_LOOKUP_HASH,   // Hash set of the edges, O(nEdges) memory
+  EDGE_LOOKUP_AUTO    // The smaller of both, once the graph is read
+}EDGELOOKUP;
+
+// Random number generators (see rngModule.h)
+typedef enum rngType {
+  RNG_MT19937,      // GSL Mersenne twister, seeded per stream
+  RNG_XOSHIRO256PP, // xoshiro256++, streams separated by jump-ahead
+  RNG_PHILOX4X32    // Philox4x32-10, counter-based, stream in the counter
+}RNGTYPE;
+
 typedef struct settings {
   char inputFilePath[MAX_FILEPATH_SIZE];
   char inputFileName[MAX_FILENAME_SIZE];
@@ -59,6 +97,7 @@ typedef struct settings {
 
   bool gotExternalSeed : 1;
   ulint seed;
+  RNGTYPE rngType;
 
   bool isBipartiteGraph : 1;
   char bipartiteSideOfInterest;
@@ -66,13 +105,28 @@ typedef struct settings {
 
   ulint nSwaps;
   bool elneSwaps : 1;
+  bool globalSingleSwitch : 1;
+  uint nReplicas;
+  uint nThreadsPerReplica;
   bool runCurveball : 1;
+  CURVEBALLKERNEL curveballKernel;
+  bool globalCurveball : 1;
+  CURVEBALLSIDE curveballSide;
+  EDGELOOKUP edgeLookup;
   bool runSwapHeuristic : 1;
   uint nDegreesSwapHeuristic;
   uint nEventsPerDegreeSwapHeuristic;
   double thresholdTheta;
 
   uint minRelevantCooc;
+  COOCENGINE coocEngine;
+  bool incrementalCooc : 1;
+  bool fusedStats : 1;
+  bool persistentRound : 1;
+  bool pipelinedSampling : 1;
+  uint nPipelineCoocThreads;
+  bool numaPlacement : 1;
+  uint graphTestInterval;
 
   uint nSamples;
   uint nMaxSamples;
@@ -90,4 +144,10 @@ SETTINGS settings;
 
 int argParser(int argc, char **argv);
 
+const char* coocEngineName(COOCENGINE coocEngine);
+const char* curveballKernelName(CURVEBALLKERNEL curveballKernel);
+const char* curveballSideName(CURVEBALLSIDE curveballSide);
+const char* edgeLookupName(EDGELOOKUP edgeLookup);
+const char* rngTypeName(RNGTYPE rngType);
+
 #endif
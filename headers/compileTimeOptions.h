@@ -68,6 +68,22 @@
 #define DEFAULT_DATESTR ""
 #define DEFAULT_RUNINDEX ""
 #define DEFAULT_MINRELEVANTCOOC 1
+#define DEFAULT_COOCENGINE COOC_ENGINE_AUTO
+#define DEFAULT_CURVEBALLKERNEL CURVEBALL_KERNEL_HASHED
+#define DEFAULT_GLOBALCURVEBALL FALSE
+#define DEFAULT_GLOBALSINGLESWITCH FALSE
+#define DEFAULT_NREPLICAS 0 // Chosen once the graph is read
+#define DEFAULT_NTHREADSPERREPLICA 0 // Chosen once the graph is read
+#define DEFAULT_CURVEBALLSIDE CURVEBALL_SIDE_ACTORS
+#define DEFAULT_EDGELOOKUP EDGE_LOOKUP_AUTO
+#define DEFAULT_RNGTYPE RNG_MT19937
+#define DEFAULT_INCREMENTALCOOC FALSE
+#define DEFAULT_FUSEDSTATS FALSE
+#define DEFAULT_PERSISTENTROUND FALSE
+#define DEFAULT_PIPELINEDSAMPLING FALSE
+#define DEFAULT_NPIPELINECOOCTHREADS 0 // Chosen once the graph is read
+#define DEFAULT_NUMAPLACEMENT FALSE
+#define DEFAULT_GRAPHTESTINTERVAL 16
 
 // Maximum length of file path/name string
 #define MAX_FILEPATH_SIZE 2048
@@ -85,17 +101,83 @@
 // Maximum string length of an edge (node_left|node_right) of the graph
 #define MAX_EDGE_STRING_LENGTH (MAX_NODE_STRING_LENGTH*2)
 
-// The program, in particular co-occurrance computation,
-// is currently implemented expecting 16 threads
-// DO NOT CHANGE unless you are sure about it!!
-// TODO: Change to (omp_get_max_threads()) once cooc calc is generalized
-#define NUMBER_OF_THREADS 16 
-
-// Number of subblocks used from co-occurence calculation
-// DO NOT CHANGE - this must be in accordance to the number of threads impletented
-// #Threads >= (#Subblocks)(#Subblocks + 1)/2 
-// because every combination of two subblocks must be handled by a unique thread
-#define NUMBER_OF_SUBBLOCKS 5
+// Graphs randomized concurrently by each rank (replicas), and threads
+//  randomizing each one, are chosen once the graph is read, unless given
+//  (see "-replicas" and "-threadsperreplica"): as many replicas as threads,
+//  as long as all of them take at most this share of the memory available
+//  to the rank, and the remaining threads for each replica of the global
+//  randomization modes
+// The co-occurrence computation is not bound to them:
+//  it is split among all available threads (omp_get_max_threads())
+#define REPLICAS_MEMORY_SHARE 0.5
+
+// Share of the threads computing the statistics of a round of samples while
+//  the replicas are randomized towards the next one (see "-pipeline"), unless
+//  given (see "-pipelinecoocthreads")
+// The replicas have the other threads, and a snapshot each
+#define PIPELINE_COOC_THREADS_SHARE 0.25
+
+// Highest NUMA node ID looked up in /sys/devices/system/node (see "-numa")
+#define NUMA_MAX_NODES 256
+
+// Minimum number of co-occurrence tiles per thread
+// The events are split into sub-blocks of contiguous IDs and every combination
+//  of two sub-blocks (i <= j) is a tile of the co-occurrence half matrix.
+// The number of sub-blocks is the smallest one giving at least
+//  COOC_TILES_PER_THREAD * #Threads tiles, so that the tiles can be balanced
+//  among the threads according to their expected amount of work
+#define COOC_TILES_PER_THREAD 2
+
+// Actors with more than 1 / (COOC_HEAVY_ACTOR_SHARE * #Threads) of all the
+//  pairs of edges are left out of the tiles, and their pairs are computed by
+//  COOC_HEAVY_BANDS_PER_THREAD * #Threads bands of rows, dealt dynamically
+#define COOC_HEAVY_ACTOR_SHARE 4
+#define COOC_HEAVY_BANDS_PER_THREAD 8
+
+// Cache tiling of the bit matrix co-occurrence engine:
+//  each task takes COOC_BITMATRIX_ROW_TILE event rows and crosses them with
+//  panels of COOC_BITMATRIX_COL_TILE event rows, which stay in cache
+#define COOC_BITMATRIX_ROW_TILE 8
+#define COOC_BITMATRIX_COL_TILE 64
+
+// Relative cost used by the automatic co-occurrence engine selection:
+//  one pair of edges expanded by the list kernel costs as much as ANDing and
+//  popcounting COOC_AUTO_WORDS_PER_EDGE_PAIR blocks of the adj. matrix
+// With 6, the bit matrix is chosen above ~5% of edge density
+#define COOC_AUTO_WORDS_PER_EDGE_PAIR 6
+
+// Relevant pairs per thread work item when folding the narrow co-occurrences
+//  of a round into the statistics (see foldRoundStatistics())
+#define STATISTICS_FOLD_CHUNK 4096
+
+// Lists more than INTERSECTION_GALLOP_RATIO times longer than the list they
+//  are intersected with are searched by galloping instead of block compares
+//  (see markCommonEntries()). Recalibrated at startup by the adaptive
+//  curveball kernel (see calibrateTradeKernels())
+#define INTERSECTION_GALLOP_RATIO 32
+// Actor pairs with at least TRADE_STAMP_MIN_LENGTH events in both lists have
+//  their common events marked by event stamps (adaptive curveball kernel
+//  only, see markCommonEvents()), unless recalibrated at startup
+#define TRADE_STAMP_MIN_LENGTH 1024
+
+// Bounded random integers drawn ahead of time by the swap loops, except for
+//  MT19937 (see randBatchNext())
+#define RAND_BATCH_SIZE 64
+
+// Single switches drawn ahead of the one being resolved, so that the memory
+//  accesses of several switches overlap (see prefetchSwapEdges())
+#define SINGLE_SWITCH_PIPELINE_DEPTH 16
+
+// Claim bits of each graph under global single switches, each one shared by
+//  the edges that hash to it (see trySingleSwapParallel()). Concurrent
+//  switches of distinct edges seldom share one, and then one of them is drawn
+//  again
+#define SWAP_CLAIM_BITS_LOG2 16
+
+// Work of each microbenchmark of calibrateTradeKernels(), in list entries,
+//  cycling through up to TRADE_CALIBRATION_LIST_PAIRS random list pairs
+#define TRADE_CALIBRATION_ENTRIES (1u << 20)
+#define TRADE_CALIBRATION_LIST_PAIRS 64
 
 // Definition of a block of bits and its length
 // DO NOT exceed uintmax_t (uint64_t in the current architecture)
@@ -126,6 +208,10 @@ typedef uint64_t BLOCK;
 
 #define PRINT_THREADS_COMPUTING_COOCCURRENCE FALSE
 
+// Compare the original co-occurrence of the selected engine
+//  against the sub-block one, pair by pair
+#define TEST_COOC_ENGINE FALSE
+
 #define PRINT_EVENT_SELECTION_SWAP_HEURISTIC FALSE
 #define PRINT_INFO_ABOUT_SWAP_HEURISTIC_STEPS FALSE
 #define PRINT_THETA_FOR_EACH_SAMPLE_SET FALSE
@@ -136,7 +222,14 @@ typedef uint64_t BLOCK;
 
 #define PRINT_PAIR_LISTS_FOR_EXTERNAL_GROUNTTRUTH FALSE
 
+// The full graph test runs on the swap steps chosen by "-graphtestinterval",
+//  and a constant time check of the graph on the others (see graphTestStep())
 #define TEST_GRAPH TRUE
+// The hashed and stamped curveball trades add the entries they rewrite to
+//  running checksums of the degree sequences of their graph, which are
+//  compared to those of the original graph after each swap step (see
+//  checkGraphInvariants())
+#define TEST_GRAPH_INVARIANTS TRUE
 #define TEST_GRAPH_EACH_SWAP FALSE
 
 #define FORCE_THREADWISE_SEQUENTIAL_RUN FALSE
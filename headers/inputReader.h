@@ -39,13 +39,13 @@
 #include <stdio.h>   /* gets */
 #include <stdlib.h>  /* atoi, malloc */
 #include <string.h>  /* strcpy */
-#include "uthash/src/uthash.h"
 #include <math.h>
 #include <time.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include "compileTimeOptions.h"
 #include "utils.h"
+#include "uthash/src/uthash.h"
 #include "timer.h"
 #include "argParser.h"
 #include "algorithm.h"
@@ -59,6 +59,8 @@
 typedef struct mpimodule {
   int procId;
   int numProcs;
+  int numNodeProcs; // Ranks sharing the memory of this node
+  int nodeProcId;   // Rank among them
 }MPIMODULE;
 
 MPIMODULE mpiModule;
@@ -66,9 +68,11 @@ MPIMODULE mpiModule;
 
 void mpiInit (int argc, char** argv);
 
+void mpiSetReplicaLayout();
+
 void printRunSettings();
 
-ulint mpiRunSwapHeuristic(GRAPH* g, gsl_rng** randG);
+ulint mpiRunSwapHeuristic(GRAPH* g, RANDGEN** randG);
 
 bool mpiRun(int argc, char** argv);
 
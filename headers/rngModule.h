@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2019, University of Kaiserslautern
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Andre Lucas Chinazzo
+ */
+
+
+#ifndef RNGMODULE_H
+#define RNGMODULE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+#include "compileTimeOptions.h"
+#include "utils.h"
+#include "argParser.h"
+
+// Random number generator of one stream (see "-rng")
+// Streams are identified by the rank and a stream id inside the rank:
+//  - MT19937 (GSL) is seeded with seed + nThreads * rank + stream, with the
+//    threads of a rank being nReplicas x nThreadsPerReplica, as before the
+//    generator choice, so that equal seeds give equal samples
+//  - xoshiro256++ starts from the seed expanded by splitmix64, advanced by
+//    one long jump (2^192 draws) per rank and one jump (2^128) per stream
+//  - Philox4x32-10 is keyed by the seed, and counts blocks in the first two
+//    counter words, with the stream and rank in the other two
+// Hence the streams of the two latter never overlap
+typedef struct randGen {
+  RNGTYPE   type;
+  gsl_rng*  gslRandG;
+  uint64_t  xoshiroState[4];
+  uint32_t  philoxKey[2];
+  uint32_t  philoxCounter[4];
+  uint32_t  philoxOutput[4];
+  uint      nPhiloxOutputsLeft;
+}RANDGEN;
+
+RANDGEN* randGenAlloc(RNGTYPE type, ulint seed, uint rankId, uint streamId);
+void randGenFree(RANDGEN* randG);
+
+/* **************************************** */
+/* Raw generators */
+static inline uint64_t rotateLeft64(uint64_t x, int k)
+{
+  return ( x << k ) | ( x >> (64 - k) );
+}
+
+static inline uint64_t xoshiroNext(uint64_t* s)
+{
+  const uint64_t result = rotateLeft64(s[0] + s[3], 23) + s[0];
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotateLeft64(s[3], 45);
+  return result;
+}
+
+void philoxNextBlock(RANDGEN* randG);
+
+static inline uint32_t philoxNext(RANDGEN* randG)
+{
+  if ( randG->nPhiloxOutputsLeft == 0 ) {
+    philoxNextBlock(randG);
+  }
+  return randG->philoxOutput[ --randG->nPhiloxOutputsLeft ];
+}
+
+static inline uint64_t randNext64(RANDGEN* randG)
+{
+  if ( randG->type == RNG_XOSHIRO256PP ) {
+    return xoshiroNext(randG->xoshiroState);
+  }
+  uint64_t high = philoxNext(randG);
+  return ( high << 32 ) | philoxNext(randG);
+}
+/* **************************************** */
+
+/* **************************************** */
+/* Bounded integers */
+// Uniform integer of [0, bound), bound > 0
+// Lemire's multiply-and-shift, where a division is needed only to reject
+//  the rare biased values (the low word of the product below 2^64 % bound)
+static inline uint randUniformInt(RANDGEN* randG, uint bound)
+{
+  if ( randG->type == RNG_MT19937 ) {
+    return (uint) gsl_rng_uniform_int(randG->gslRandG, bound);
+  }
+  __uint128_t product = (__uint128_t) randNext64(randG) * bound;
+  uint64_t low = (uint64_t) product;
+  if ( low < bound ) {
+    const uint64_t threshold = ( -(uint64_t)bound ) % bound;
+    while ( low < threshold ) {
+      product = (__uint128_t) randNext64(randG) * bound;
+      low = (uint64_t) product;
+    }
+  }
+  return (uint)( product >> 64 );
+}
+
+void randUniformInts(RANDGEN* randG, uint bound, uint* values, uint nValues);
+
+// Values of a fixed bound drawn ahead of time, RAND_BATCH_SIZE at a time
+// MT19937 draws them one at a time, which keeps the order of its draws, and
+//  so its samples, unchanged
+typedef struct randBatch {
+  uint values[RAND_BATCH_SIZE];
+  uint nValues;
+  uint nextValue;
+  uint bound;
+}RANDBATCH;
+
+static inline void randBatchInit(RANDBATCH* batch, uint bound)
+{
+  batch->nValues = 0;
+  batch->nextValue = 0;
+  batch->bound = bound;
+}
+
+static inline uint randBatchNext(RANDGEN* randG, RANDBATCH* batch)
+{
+  if ( batch->nextValue == batch->nValues ) {
+    batch->nValues = ( randG->type == RNG_MT19937 ) ? 1 : RAND_BATCH_SIZE;
+    randUniformInts(randG, batch->bound, batch->values, batch->nValues);
+    batch->nextValue = 0;
+  }
+  return batch->values[ batch->nextValue++ ];
+}
+/* **************************************** */
+
+#endif // RNGMODULE_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, University of Kaiserslautern
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Andre Lucas Chinazzo
+ */
+
+
+
+#ifndef SIMDMODULE_H
+#define SIMDMODULE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+#include "compileTimeOptions.h"
+#include "utils.h"
+
+// Instruction set extensions available at run time
+// The kernels below are compiled for each extension through function
+//  attributes, so the binary does not depend on the -march used to build it;
+//  the fastest supported version is selected once, by initCpuFeatures()
+typedef struct cpuFeatures {
+  bool popcnt;
+  bool avx2;
+  bool avx512f;
+  bool avx512bw;
+  bool avx512vpopcntdq;
+}CPUFEATURES;
+
+CPUFEATURES cpuFeatures;
+
+void initCpuFeatures();
+
+/* **************************************** */
+/* Bit matrix kernels */
+// Popcount of the bitwise AND of every row of A with every row of B
+//  (A.B^T over the (AND, popcount) semiring), register tiled like a GEMM:
+//  counts[ rowA * nRowsB + rowB ] = popcount( A[rowA] & B[rowB] )
+// Rows are nWords blocks long and contiguous in memory
+typedef void (*ANDPOPCOUNTBLOCK)(const BLOCK* rowsA, uint nRowsA,
+                                 const BLOCK* rowsB, uint nRowsB,
+                                 uint nWords, uint* counts);
+ANDPOPCOUNTBLOCK andPopCountBlock;
+const char* andPopCountBlockName;
+/* **************************************** */
+
+/* **************************************** */
+/* Statistics kernels */
+// Largest co-occurrence held by the narrow (16-bit) counters
+#define NARROW_COOC_MAX UINT16_MAX
+
+// Folds the co-occurrences of a round of nGraphs graphs into the statistics
+//  of nPairs consecutive relevant pairs:
+//  batchCooc[ graphIt * batchStride + pairIt ] is the co-occurrence of pair
+//  pairIt in graph graphIt, which is also the tie-break of the p-value
+//  (see threadUpdateTmpResult())
+// The round is summed up in narrow lanes, and the wide statistics are read
+//  and written only once per round
+typedef void (*FOLDSTATISTICSBATCH)(const uint16_t* batchCooc,
+                                    size_t batchStride, uint nGraphs,
+                                    const uint16_t* originalCooc, uint nPairs,
+                                    ulint* coocSum, ulint* coocSquareSum,
+                                    uint* pValue);
+FOLDSTATISTICSBATCH foldStatisticsBatch;
+const char* foldStatisticsBatchName;
+/* **************************************** */
+
+/* **************************************** */
+/* Sorted set kernels */
+// Bit i of a list's bitmap refers to list[i]
+#define isMarkedEntry(bitmap, i) ( ( (bitmap)[(i) / 8] >> ((i) % 8) ) & 1 )
+
+// Marks the entries shared by two ascending lists of distinct values:
+//  bit i of isCommonA (isCommonB) is set iff listA[i] (listB[i]) is also in
+//  the other list. The bitmaps hold (length + 7) / 8 bytes, and are cleared
+//  by the kernel
+// Returns the number of shared entries
+// Blocks of both lists are compared all-against-all in vector registers,
+//  unless one list is much longer, which is then searched by galloping
+typedef uint (*MARKCOMMONENTRIES)(const uint* listA, uint lengthA,
+                                  const uint* listB, uint lengthB,
+                                  uint8_t* isCommonA, uint8_t* isCommonB);
+MARKCOMMONENTRIES markCommonEntries;
+const char* markCommonEntriesName;
+// Length ratio above which the longer list is searched by galloping
+//  (INTERSECTION_GALLOP_RATIO, unless recalibrated)
+uint intersectionGallopRatio;
+/* **************************************** */
+
+#endif // SIMDMODULE_H
@@ -37,6 +37,7 @@
 #define THREADS_H
 
 #include <omp.h>
+#include <sched.h>
 #include <stdio.h>   /* gets */
 #include <stdlib.h>  /* atoi, malloc */
 #include <string.h>  /* strcpy */
@@ -44,11 +45,11 @@
 #include <time.h>
 #include <sys/time.h>
 #include <unistd.h>
-#include <gsl/gsl_rng.h>
 #include "compileTimeOptions.h"
 #include "utils.h"
 #include "timer.h"
 #include "argParser.h"
+#include "rngModule.h"
 #include "algorithm.h"
 #include "inputReader.h"
 
@@ -62,33 +63,89 @@ typedef struct openmp{
 omp_lock_t forceSequentialLock; // Global lock used to force sequential run
 #endif
 
+// Cpus of the rank, ordered by NUMA node, to which threads are pinned (see
+//  "-numa" and threadPin())
+// nCpus is zero when threads are not pinned by this module
+typedef struct numaTopology {
+  uint  nCpus;
+  uint  nNodes;
+  uint* cpus;
+  // Cpus of the swap stage while the pipelined stages run, the co-occurrence
+  //  stage having the others (see threadRunPipelinedStep()), zero otherwise
+  uint  nSwapStageCpus;
+}NUMATOPOLOGY;
+
+NUMATOPOLOGY numaTopology;
+
 // Helper functions
 void threadInit(OPENMP* openMP);
 void threadBarrier();
 void threadEnd();
+uint nRankThreads();
+void threadPin();
 
 
 // Interface functions
-gsl_rng** threadRandInit(ulint seed);
+bool initNumaTopology(uint nodeProcId, uint nNodeProcs);
+void deleteNumaTopology();
+
+RANDGEN** threadRandInit(ulint seed, uint rankId);
+
+bool threadAllocScratch();
 
 bool threadCopyGraph(GRAPH* g);
 
 bool threadGetOriginalCooc(GRAPH* g);
 
-bool threadRunSwapsStep(GRAPH* g, gsl_rng **randGenerator, ulint nSwaps);
+bool threadInitIncrementalCooc(GRAPH* g);
+
+void threadFirstTouchTmpResult(TMPRESULT* tmpResult);
+
+bool threadInitSnapshots(GRAPH* g, GRAPH* snapshots);
+
+bool threadRunSwapsStep(GRAPH* g, RANDGEN **randGenerator, ulint nSwaps);
+
+bool threadHandOffSnapshots(GRAPH* g, GRAPH* snapshots);
+bool threadRunPipelinedStep(GRAPH* g, GRAPH* snapshots, RANDGEN** randG,
+                            ulint nSwaps, TMPRESULT* tmpResult,
+                            TIMER* swapTimer, TIMER* coocTimer);
 
 bool threadUpdateTmpResult(GRAPH* g, TMPRESULT* tmpResult);
+bool threadUpdateTmpResultFused(GRAPH* g, TMPRESULT* tmpResult);
+
+bool threadRunSamplingRound(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                            TMPRESULT* tmpResult);
 
 void threadDeleteGraph(GRAPH* g);
 
-void threadRandFree(gsl_rng** randG);
+void threadFreeScratch();
+
+void threadRandFree(RANDGEN** randG);
 
 // Core functions
 bool threadGetCooc(GRAPH* g, uint** coocs);
-
-bool threadRunSingleSwitchesBipartite(GRAPH* g, gsl_rng** randG, ulint nSwaps);
-bool threadRunSingleSwitchesGeneral(GRAPH* g, gsl_rng** randG, ulint nSwaps);
-bool threadRunCurveballBipartite(GRAPH* g, gsl_rng** randG, ulint nSwaps);
+bool threadPrepareCoocRows(GRAPH* g);
+void threadFoldCoocRows(GRAPH* g, TMPRESULT* tmpResult, ulint* coocSums,
+                        bool* currentStatus);
+bool threadCheckCoocSums(GRAPH* g, ulint* coocSums);
+
+bool threadRunSingleSwitchesBipartite(GRAPH* g, RANDGEN** randG, ulint nSwaps);
+bool threadRunGlobalSingleSwitchesBipartite(GRAPH* g, RANDGEN** randG,
+                                            ulint nSwaps);
+bool threadRunSingleSwitchesGeneral(GRAPH* g, RANDGEN** randG, ulint nSwaps);
+bool threadRunCurveballBipartite(GRAPH* g, RANDGEN** randG, ulint nSwaps);
+void threadRunCurveballReplica(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                               uint graphIt, omp_lock_t* writeStderrLock,
+                               bool* returnFlag);
+void threadRunBipartiteSwitchesReplica(GRAPH* g, RANDGEN** randG,
+                                       ulint nSwaps, uint graphIt,
+                                       omp_lock_t* writeStderrLock,
+                                       bool* returnFlag);
+void threadRunGeneralSwitchesReplica(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                                     uint graphIt, omp_lock_t* writeStderrLock,
+                                     bool* returnFlag);
+bool threadRunGlobalCurveballBipartite(GRAPH* g, RANDGEN** randG,
+                                       ulint nSwaps);
 
 
 #endif
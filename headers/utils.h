@@ -102,22 +102,38 @@
     (pointer) = calloc(_size, sizeof (*pointer));                       \
 }while(0)
 
+// Half (triangular) matrix: row r has (nRows - r) elements
+// All rows are stored contiguously, in a single allocation pointed by the
+//  first row, so the matrix can be cleared, copied or sent as one buffer
+//  of halfMatrixSize(nRows) elements. Free it with halfMatrixFree()
+#define halfMatrixSize(nRows) ( (size_t)(nRows) * ((size_t)(nRows) + 1) / 2 )
+
 #define halfMatrixCalloc(pointer, nRows)                                \
   do {                                                                  \
     size_t _nRows = (nRows);                                            \
     arrayCalloc((pointer), _nRows);                                     \
-    if ( (pointer) != NULL ) {                                          \
-      for (size_t _row = 0; _row < _nRows; ++_row) {                    \
-        arrayCalloc((pointer)[_row], _nRows - _row);                    \
-        if ( (pointer)[_row] == NULL ) {                                \
-          /* TODO: Free already allocated blocks */                     \
-          (pointer) = NULL;                                             \
-          break;                                                        \
+    if ( (pointer) != NULL && _nRows > 0 ) {                            \
+      arrayCalloc((pointer)[0], halfMatrixSize(_nRows));                \
+      if ( (pointer)[0] == NULL ) {                                     \
+        free(pointer);                                                  \
+        (pointer) = NULL;                                               \
+      } else {                                                          \
+        for (size_t _row = 1; _row < _nRows; ++_row) {                  \
+          (pointer)[_row] = (pointer)[_row - 1] + (_nRows - _row + 1);  \
         }                                                               \
       }                                                                 \
     }                                                                   \
 }while(0)
 
+#define halfMatrixFree(pointer, nRows)                                  \
+  do {                                                                  \
+    if ( (pointer) != NULL ) {                                          \
+      if ( (nRows) > 0 ) { free((pointer)[0]); }                        \
+      free(pointer);                                                    \
+      (pointer) = NULL;                                                 \
+    }                                                                   \
+}while(0)
+
 #define fullMatrixCalloc(pointer, nRows, nCols)                         \
   do {                                                                  \
     size_t _nRows = (nRows);                                            \
@@ -142,10 +158,15 @@ typedef unsigned char bool;
 
 float getPeakRSS();
 float getCurrentRSS();
+size_t getAvailableMemory();
 
 BLOCK checkBitOnBlockArray(BLOCK* blockArray, size_t bitIndex, size_t blockOffset);
 void setBitOnBlockArray(BLOCK* blockArray, size_t bitIndex, size_t blockOffset);
 void clearBitOnBlockArray(BLOCK* blockArray, size_t bitIndex, size_t blockOffset);
+BLOCK atomicSetBitOnBlockArray(BLOCK* blockArray, size_t bitIndex,
+                               size_t blockOffset);
+void atomicClearBitOnBlockArray(BLOCK* blockArray, size_t bitIndex,
+                                size_t blockOffset);
 uint popCount(BLOCK i);
 
 double deviation_uint(ulint oriSumOfElements, ulint sumOfElements, uint sampleSize );
@@ -156,4 +177,59 @@ float zScore_uint(ulint oriSumOfElements,
 
 char *getFilenameExt(const char *filename);
 
+// Bump allocator for scratch memory of one thread
+// Arrays are taken in order from one preallocated buffer and given back all
+//  at once, by going back to a mark taken before them (arenaMark() and
+//  arenaRelease()), so hot paths neither call the allocator nor keep
+//  arrays as large as a node degree on the stack
+typedef struct scratchArena {
+  char*   base;
+  size_t  capacity;
+  size_t  used;
+}SCRATCHARENA;
+
+// Every array starts at a cache line, so SIMD kernels may use aligned loads
+#define ARENA_ALIGNMENT 64
+#define arenaArraySize(type, size)                                      \
+  ( ( (size_t)(size) * sizeof (type) + ARENA_ALIGNMENT - 1 )            \
+    / ARENA_ALIGNMENT * ARENA_ALIGNMENT )
+
+bool arenaReserve(SCRATCHARENA* arena, size_t capacity);
+void arenaFree(SCRATCHARENA* arena);
+
+static inline void* arenaPush(SCRATCHARENA* arena, size_t size)
+{
+  // NULL if the arena was not reserved large enough
+  size = ( size + ARENA_ALIGNMENT - 1 ) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  if ( size > arena->capacity - arena->used ) { return NULL; }
+  void* pointer = arena->base + arena->used;
+  arena->used += size;
+  return pointer;
+}
+
+static inline size_t arenaMark(const SCRATCHARENA* arena)
+{
+  return arena->used;
+}
+
+static inline void arenaRelease(SCRATCHARENA* arena, size_t mark)
+{
+  arena->used = mark;
+}
+
+#define arenaArray(pointer, arena, size)                                \
+  do {                                                                  \
+    (pointer) = arenaPush((arena), (size_t)(size) * sizeof (*pointer)); \
+}while(0)
+
+// The uthash tables take their table and buckets from the arena set for the
+//  calling thread, if any, so that the pool hash of the hashed curveball
+//  trades does not call the allocator (see curveballTrade())
+// Included before uthash.h by every header using it
+#define uthash_malloc(size) uthashArenaMalloc(size)
+#define uthash_free(pointer, size) uthashArenaFree(pointer)
+void setUthashArena(SCRATCHARENA* arena);
+void* uthashArenaMalloc(size_t size);
+void uthashArenaFree(void* pointer);
+
 #endif
@@ -65,7 +65,7 @@ int cmpZStar (PAIR *a, PAIR *b)
     else if (a->zScore > b->zScore)
       return -1;
     else {
-      return (2*((int) gsl_rng_uniform_int (randC, 2))) - 1;
+      return (2*((int) randUniformInt(randC, 2))) - 1;
     }
   }
 }
@@ -97,11 +97,11 @@ PAIR qselect(PAIR *v, uint len, uint k)
 
 /* **************************************** */
 /* Shuffle related functions */
-void shuffle(unsigned *array, size_t n, gsl_rng* thisRandG)
+void shuffle(unsigned *array, size_t n, RANDGEN* thisRandG)
 {
   if (n > 1) {
     for (size_t i = 0; i < n - 1; i++) {
-      size_t j = i + (size_t) gsl_rng_uniform_int (thisRandG, n-i);
+      size_t j = i + (size_t) randUniformInt(thisRandG, n-i);
       unsigned t = array[j];
       array[j] = array[i];
       array[i] = t;
@@ -109,7 +109,7 @@ void shuffle(unsigned *array, size_t n, gsl_rng* thisRandG)
   }
 }
 
-void shufflePartial(unsigned *array, size_t n, gsl_rng* thisRandG, uint nEvents)
+void shufflePartial(unsigned *array, size_t n, RANDGEN* thisRandG, uint nEvents)
 {
   if(n > 1)
   {
@@ -118,7 +118,7 @@ void shufflePartial(unsigned *array, size_t n, gsl_rng* thisRandG, uint nEvents)
       fprintf(curveballDebugFile,"%u Elements in the Pool\n", (uint)n);
     #endif
     for (size_t i = 0; i < nEvents; i++) {
-      size_t j = i + (size_t) gsl_rng_uniform_int (thisRandG, n-i);
+      size_t j = i + (size_t) randUniformInt(thisRandG, n-i);
       unsigned t = array[j];
       array[j] = array[i];
       array[i] = t;
@@ -152,6 +152,41 @@ void shufflePartial(unsigned *array, size_t n, gsl_rng* thisRandG, uint nEvents)
 
 /* **************************************** */
 /* Edges swapping related functions */
+
+// Edge queries and updates of the single switches, through the adj. matrix
+//  or the edge set (see "-edgelookup")
+// Non-bipartite graphs have self-loops in the matrix main diagonal, which
+//  the edge set only reports, so that the swap checks stay the same
+static inline bool isSwapEdge(GRAPH* g, uint actorId, uint eventId)
+{
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    return ( !settings.isBipartiteGraph && actorId == eventId )
+           || edgeSetContains(&g->edgeSet, actorId, eventId);
+  }
+  return checkBitOnBlockArray(g->adjMatrix, actorId,
+                              eventId * graphInfo.nBlocksPerEvent) != 0;
+}
+
+static inline void addSwapEdge(GRAPH* g, uint actorId, uint eventId)
+{
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    edgeSetInsert(&g->edgeSet, actorId, eventId);
+  } else {
+    setBitOnBlockArray(g->adjMatrix, actorId,
+                       eventId * graphInfo.nBlocksPerEvent);
+  }
+}
+
+static inline void removeSwapEdge(GRAPH* g, uint actorId, uint eventId)
+{
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    edgeSetRemove(&g->edgeSet, actorId, eventId);
+  } else {
+    clearBitOnBlockArray(g->adjMatrix, actorId,
+                         eventId * graphInfo.nBlocksPerEvent);
+  }
+}
+
 void singleSwapBipartite(GRAPH* g, uint* edgeIds)
 {
   uint eventIds[2], actorIds[2];
@@ -163,24 +198,25 @@ void singleSwapBipartite(GRAPH* g, uint* edgeIds)
   actorIds[1] = g->actorEdgeMaps[ edgeIds[1] ];
   
   //Check if it is swappable
-  if ( checkBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[0]*graphInfo.nBlocksPerEvent) ) {  //Check Non-Edge
+  if ( isSwapEdge(g, actorIds[1], eventIds[0]) ) {  //Check Non-Edge
     return;
   }
-  else if ( checkBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[1]*graphInfo.nBlocksPerEvent) ) { //Check Non-Edge
+  else if ( isSwapEdge(g, actorIds[0], eventIds[1]) ) { //Check Non-Edge
       return;
   }
   else {
-    //Swap edges in adjacency matrix
-    setBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[0]*graphInfo.nBlocksPerEvent);
-    setBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[1]*graphInfo.nBlocksPerEvent);
+    //Swap edges in adjacency matrix (or edge set)
+    addSwapEdge(g, actorIds[1], eventIds[0]);
+    addSwapEdge(g, actorIds[0], eventIds[1]);
 
-    clearBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[0]*graphInfo.nBlocksPerEvent);
-    clearBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[1]*graphInfo.nBlocksPerEvent);
+    removeSwapEdge(g, actorIds[0], eventIds[0]);
+    removeSwapEdge(g, actorIds[1], eventIds[1]);
 
     //Swap edges in adjacency list
     uint tmp = g->actorAdjLists[ edgeIds[0] ];
     g->actorAdjLists[ edgeIds[0] ] = g->actorAdjLists[ edgeIds[1] ];
     g->actorAdjLists[ edgeIds[1] ] = tmp;
+    g->sortedActorAdjLists = FALSE;
   }
 
 }
@@ -199,21 +235,21 @@ void singleSwapGeneral(GRAPH* g, uint* edgeIds)
   redundantEdgeIds[1] = g->edgeLinks[ edgeIds[1] ];
   
   //Check if it is swappable
-  if ( checkBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[0] * graphInfo.nBlocksPerEvent) ) {
+  if ( isSwapEdge(g, actorIds[1], eventIds[0]) ) {
     return;
-  } else if ( checkBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[1] * graphInfo.nBlocksPerEvent) ) {
+  } else if ( isSwapEdge(g, actorIds[0], eventIds[1]) ) {
       return;
   }
   else {
-    setBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[0]*graphInfo.nBlocksPerEvent );
-    setBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[1]*graphInfo.nBlocksPerEvent );
-    setBitOnBlockArray(g->adjMatrix, eventIds[1], actorIds[0]*graphInfo.nBlocksPerEvent );
-    setBitOnBlockArray(g->adjMatrix, eventIds[0], actorIds[1]*graphInfo.nBlocksPerEvent );
+    addSwapEdge(g, actorIds[1], eventIds[0]);
+    addSwapEdge(g, actorIds[0], eventIds[1]);
+    addSwapEdge(g, eventIds[1], actorIds[0]);
+    addSwapEdge(g, eventIds[0], actorIds[1]);
 
-    clearBitOnBlockArray(g->adjMatrix, actorIds[0], eventIds[0]*graphInfo.nBlocksPerEvent );
-    clearBitOnBlockArray(g->adjMatrix, actorIds[1], eventIds[1]*graphInfo.nBlocksPerEvent );
-    clearBitOnBlockArray(g->adjMatrix, eventIds[0], actorIds[0]*graphInfo.nBlocksPerEvent );
-    clearBitOnBlockArray(g->adjMatrix, eventIds[1], actorIds[1]*graphInfo.nBlocksPerEvent );
+    removeSwapEdge(g, actorIds[0], eventIds[0]);
+    removeSwapEdge(g, actorIds[1], eventIds[1]);
+    removeSwapEdge(g, eventIds[0], actorIds[0]);
+    removeSwapEdge(g, eventIds[1], actorIds[1]);
 
     uint tmp;
     //Swap edges in adjacency list (randomly selected pair and their's redundants)
@@ -224,6 +260,7 @@ void singleSwapGeneral(GRAPH* g, uint* edgeIds)
     tmp = g->actorAdjLists[ redundantEdgeIds[1] ];
     g->actorAdjLists[ redundantEdgeIds[1] ] = g->actorAdjLists[ redundantEdgeIds[0] ];
     g->actorAdjLists[ redundantEdgeIds[0] ] = tmp;
+    g->sortedActorAdjLists = FALSE;
 
     // Correct links between redundant edges
     tmp = g->edgeLinks[ edgeIds[0] ];
@@ -238,27 +275,467 @@ void singleSwapGeneral(GRAPH* g, uint* edgeIds)
 
 }
 
+// Locks the entry, unless it is already locked. Returns whether it did, and
+//  its event
+static inline bool tryLockSwapEntry(uint* entry, uint* eventId)
+{
+  *eventId = __atomic_load_n(entry, __ATOMIC_RELAXED);
+  return ( !( *eventId & SWAP_ENTRY_LOCK_BIT )
+           && __atomic_compare_exchange_n(entry, eventId,
+                                          *eventId | SWAP_ENTRY_LOCK_BIT,
+                                          FALSE, __ATOMIC_ACQUIRE,
+                                          __ATOMIC_RELAXED) );
+}
+
+// Claim bit of the edge (actorId, eventId) (see SWAP_CLAIM_BITS_LOG2)
+static inline uint swapClaimBit(uint actorId, uint eventId)
+{
+  uint64_t key = (uint64_t)eventId * graphInfo.nActors + actorId;
+  return (uint)( ( key * 0x9E3779B97F4A7C15ull )
+                 >> ( 64 - SWAP_CLAIM_BITS_LOG2 ) );
+}
+
+static inline bool tryClaimSwapEdge(BLOCK* swapClaims, uint claimBit)
+{
+  const BLOCK mask = (BLOCK)1 << (claimBit % BITS_PER_BLOCK);
+  return !( __atomic_fetch_or(&swapClaims[ claimBit / BITS_PER_BLOCK ],
+                              mask, __ATOMIC_ACQUIRE) & mask );
+}
+
+static inline void releaseSwapEdge(BLOCK* swapClaims, uint claimBit)
+{
+  const BLOCK mask = (BLOCK)1 << (claimBit % BITS_PER_BLOCK);
+  __atomic_fetch_and(&swapClaims[ claimBit / BITS_PER_BLOCK ], ~mask,
+                     __ATOMIC_RELEASE);
+}
+
+size_t nSwapClaimBlocks()
+{
+  return ( ((size_t)1 << SWAP_CLAIM_BITS_LOG2) + BITS_PER_BLOCK - 1 )
+         / BITS_PER_BLOCK;
+}
+
+bool trySingleSwapParallel(GRAPH* g, uint* edgeIds)
+{
+  uint eventIds[2], actorIds[2];
+
+  // The same edge twice is never swappable (see singleSwapBipartite())
+  if ( edgeIds[0] == edgeIds[1] ) { return TRUE; }
+
+  // Entries owned by a concurrent switch: give up, rather than wait for it
+  if ( !tryLockSwapEntry( &g->actorAdjLists[ edgeIds[0] ], &eventIds[0] ) ) {
+    return FALSE;
+  }
+  if ( !tryLockSwapEntry( &g->actorAdjLists[ edgeIds[1] ], &eventIds[1] ) ) {
+    __atomic_store_n( &g->actorAdjLists[ edgeIds[0] ], eventIds[0],
+                      __ATOMIC_RELEASE );
+    return FALSE;
+  }
+
+  actorIds[0] = g->actorEdgeMaps[ edgeIds[0] ];
+  actorIds[1] = g->actorEdgeMaps[ edgeIds[1] ];
+
+  // New edges claimed by a concurrent switch, which may be creating them:
+  //  give up as well. Once claimed, their bits are set by real edges only
+  const uint claimBits[2] = { swapClaimBit(actorIds[1], eventIds[0]),
+                              swapClaimBit(actorIds[0], eventIds[1]) };
+  bool isClaimed = tryClaimSwapEdge(g->swapClaims, claimBits[0]);
+  if ( isClaimed && claimBits[1] != claimBits[0]
+       && !tryClaimSwapEdge(g->swapClaims, claimBits[1]) ) {
+    releaseSwapEdge(g->swapClaims, claimBits[0]);
+    isClaimed = FALSE;
+  }
+
+  // Check Non-Edges, setting them on the way
+  bool isSwapped = FALSE;
+  if ( isClaimed
+       && !atomicSetBitOnBlockArray(g->adjMatrix, actorIds[1],
+                                    eventIds[0]*graphInfo.nBlocksPerEvent) ) {
+    if ( !atomicSetBitOnBlockArray(g->adjMatrix, actorIds[0],
+                                   eventIds[1]*graphInfo.nBlocksPerEvent) ) {
+      // Old edges are owned through their entries: no one else clears them
+      atomicClearBitOnBlockArray(g->adjMatrix, actorIds[0],
+                                 eventIds[0]*graphInfo.nBlocksPerEvent);
+      atomicClearBitOnBlockArray(g->adjMatrix, actorIds[1],
+                                 eventIds[1]*graphInfo.nBlocksPerEvent);
+      isSwapped = TRUE;
+    } else {
+      // Give back the first new edge, which no one read under its claim
+      atomicClearBitOnBlockArray(g->adjMatrix, actorIds[1],
+                                 eventIds[0]*graphInfo.nBlocksPerEvent);
+    }
+  }
+  if ( isClaimed ) {
+    if ( claimBits[1] != claimBits[0] ) {
+      releaseSwapEdge(g->swapClaims, claimBits[1]);
+    }
+    releaseSwapEdge(g->swapClaims, claimBits[0]);
+  }
+
+  // Swap edges in adjacency list, if swappable, unlocking the entries
+  __atomic_store_n( &g->actorAdjLists[ edgeIds[0] ],
+                    eventIds[ isSwapped ? 1 : 0 ], __ATOMIC_RELEASE );
+  __atomic_store_n( &g->actorAdjLists[ edgeIds[1] ],
+                    eventIds[ isSwapped ? 0 : 1 ], __ATOMIC_RELEASE );
+
+  return isClaimed;
+}
+
+EDGELOOKUP autoSelectEdgeLookup()
+{
+  // The smaller structure: the matrix takes a bit per (event, actor) pair,
+  //  the edge set a 64-bit slot per edge, at most half of them in use
+  double adjMatrixBytes = (double) graphInfo.nBlocksAdjMatrix * sizeof(BLOCK);
+  double edgeSetBytes = (double) edgeSetSlots(graphInfo.nEdges)
+                        * sizeof(uint64_t);
+  if ( edgeSetBytes < adjMatrixBytes ) {
+    return EDGE_LOOKUP_HASH;
+  }
+  return EDGE_LOOKUP_MATRIX;
+}
+
+// Smallest power of two with at least twice as many slots as keys
+size_t edgeSetSlots(size_t nKeys)
+{
+  size_t nSlots = 2;
+  while ( nSlots < 2 * nKeys ) { nSlots <<= 1; }
+  return nSlots;
+}
+
+bool allocEdgeSet(EDGESET* edgeSet, size_t nKeys)
+{
+  const size_t nSlots = edgeSetSlots(nKeys);
+  uint log2Slots = 0;
+  while ( ( (size_t) 1 << log2Slots ) < nSlots ) { ++log2Slots; }
+
+  deleteEdgeSet(edgeSet);
+  edgeSet->keys = malloc(nSlots * sizeof *edgeSet->keys);
+  if ( edgeSet->keys == NULL ) { MEM_ERROR; }
+  edgeSet->slotShift = 64 - log2Slots;
+  edgeSet->slotMask = nSlots - 1;
+  clearEdgeSet(edgeSet);
+
+  return SUCCESS;
+}
+
+void deleteEdgeSet(EDGESET* edgeSet)
+{
+  free(edgeSet->keys);
+  memset(edgeSet, 0, sizeof *edgeSet);
+}
+
+void clearEdgeSet(EDGESET* edgeSet)
+{
+  // All bytes 0xFF: every slot holds EDGE_SET_EMPTY_KEY
+  memset(edgeSet->keys, 0xFF, (edgeSet->slotMask + 1) * sizeof *edgeSet->keys);
+  edgeSet->nKeys = 0;
+}
+
+bool edgeSetContains(const EDGESET* edgeSet, uint actorId, uint eventId)
+{
+  const uint64_t key = edgeSetKey(actorId, eventId);
+  for (size_t slot = edgeSetSlot(edgeSet, key); ;
+       slot = (slot + 1) & edgeSet->slotMask) {
+    if ( edgeSet->keys[slot] == key ) { return TRUE; }
+    if ( edgeSet->keys[slot] == EDGE_SET_EMPTY_KEY ) { return FALSE; }
+  }
+}
+
+// The key must not be in the set, and the set must have room for it
+//  (see allocEdgeSet()), which the swaps keep by removing as many edges
+void edgeSetInsert(EDGESET* edgeSet, uint actorId, uint eventId)
+{
+  const uint64_t key = edgeSetKey(actorId, eventId);
+  size_t slot = edgeSetSlot(edgeSet, key);
+  while ( edgeSet->keys[slot] != EDGE_SET_EMPTY_KEY ) {
+    slot = (slot + 1) & edgeSet->slotMask;
+  }
+  edgeSet->keys[slot] = key;
+  edgeSet->nKeys++;
+}
+
+void edgeSetRemove(EDGESET* edgeSet, uint actorId, uint eventId)
+{
+  const uint64_t key = edgeSetKey(actorId, eventId);
+  size_t hole = edgeSetSlot(edgeSet, key);
+  while ( edgeSet->keys[hole] != key ) {
+    if ( edgeSet->keys[hole] == EDGE_SET_EMPTY_KEY ) { return; } // Not found
+    hole = (hole + 1) & edgeSet->slotMask;
+  }
+
+  // Backward shift: each following key of the probe sequence that could
+  //  have been stored in the hole moves into it, leaving its slot as the hole
+  for (size_t slot = (hole + 1) & edgeSet->slotMask;
+       edgeSet->keys[slot] != EDGE_SET_EMPTY_KEY;
+       slot = (slot + 1) & edgeSet->slotMask) {
+    const size_t home = edgeSetSlot(edgeSet, edgeSet->keys[slot]);
+    // Distances, with wrap-around, from its home slot and from the hole
+    if ( ( (slot - home) & edgeSet->slotMask )
+         >= ( (slot - hole) & edgeSet->slotMask ) ) {
+      edgeSet->keys[hole] = edgeSet->keys[slot];
+      hole = slot;
+    }
+  }
+  edgeSet->keys[hole] = EDGE_SET_EMPTY_KEY;
+  edgeSet->nKeys--;
+}
+
+bool edgeSetFromAdjLists(GRAPH* g)
+{
+  clearEdgeSet(&g->edgeSet);
+  if ( g->staleActorAdjLists ) { // Event lists current (event-side trades)
+    for(uint eventIt = 0; eventIt < graphInfo.nEvents; ++eventIt) {
+      for(uint listIt = g->eventAccumulatedDegrees[eventIt];
+          listIt < g->eventAccumulatedDegrees[eventIt + 1]; ++listIt) {
+        edgeSetInsert(&g->edgeSet, g->eventAdjLists[ listIt ], eventIt);
+      }
+    }
+    return SUCCESS;
+  }
+  for(uint actorIt = 0; actorIt < graphInfo.nActors; ++actorIt) {
+    uint actorAdjListFirst = g->actorAccumulatedDegrees[actorIt];
+    uint actorAdjListLast = g->actorAccumulatedDegrees[actorIt + 1];
+    for(uint edgeIt = actorAdjListFirst; edgeIt < actorAdjListLast; ++edgeIt) {
+      edgeSetInsert(&g->edgeSet, actorIt, g->actorAdjLists[ edgeIt ]);
+    }
+  }
+
+  return SUCCESS;
+}
 /* **************************************** */
 
 /* **************************************** */
 /* Curveball randomization related functions */
-bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
+bool isEventSideCurveball()
+{
+  // "auto" is resolved once the graph is read (see autoSelectCurveballSide())
+  return ( settings.runCurveball
+           && settings.curveballSide == CURVEBALL_SIDE_EVENTS );
+}
+
+uint nTradeLists()
+{
+  // Number of nodes of the traded side, i.e. of lists drawn for a trade
+  return isEventSideCurveball() ? graphInfo.nEvents : graphInfo.nActors;
+}
+
+uint nTradeListIds()
+{
+  // Number of different IDs in the traded lists (nodes of the other side)
+  return isEventSideCurveball() ? graphInfo.nActors : graphInfo.nEvents;
+}
+
+uint maxTradeListLength()
+{
+  return isEventSideCurveball() ? graphInfo.maxEventDegree
+                                : graphInfo.maxActorDegree;
+}
+
+static inline uint* tradeAdjList(GRAPH* g, uint nodeId, uint* length)
+{
+  // Adjacency list of a node of the traded side, and its length
+  // Event lists hold actor IDs, which the kernels handle as their "events"
+  const uint* accumulatedDegrees = g->actorAccumulatedDegrees;
+  uint* adjLists = g->actorAdjLists;
+  if ( isEventSideCurveball() ) {
+    accumulatedDegrees = g->eventAccumulatedDegrees;
+    adjLists = g->eventAdjLists;
+  }
+  *length = accumulatedDegrees[nodeId+1] - accumulatedDegrees[nodeId];
+  return &adjLists[ accumulatedDegrees[nodeId] ];
+}
+
+static inline ulint degreeChecksumTerm(uint nodeId)
+{
+  // Mixed (splitmix64) node ID, summed over the edges into the degree
+  //  sequence checksums, which do not depend on the order of the lists
+  ulint z = ( nodeId + 1ULL ) * 0x9E3779B97F4A7C15ULL;
+  z = ( z ^ (z >> 30) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ (z >> 27) ) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline void setTradeListEntry(GRAPH* g, uint* list, uint length,
+                                     uint position, uint id,
+                                     TRADESCRATCH* scratch)
+{
+  // Rewrites an entry of a traded list. The ID it replaces leaves the degree
+  //  checksum delta of the trade, and the new one enters it (see
+  //  curveballTrade()), so only the rewritten entries are hashed
+  #if TEST_GRAPH_INVARIANTS
+  if ( list[position] != id ) {
+    scratch->checksumDelta += degreeChecksumTerm(id)
+                              - degreeChecksumTerm(list[position]);
+  }
+  #endif
+  // Incremental co-occurrence: only the pairs of the replaced entries change
+  if ( g->cooc != NULL ) {
+    coocReplaceListEntry(g->cooc, list, length, position, id);
+  } else {
+    list[position] = id;
+  }
+}
+
+static inline void setSortedTradeLists(GRAPH* g, bool isSorted)
+{
+  if ( isEventSideCurveball() ) {
+    g->sortedEventAdjLists = isSorted;
+  } else {
+    g->sortedActorAdjLists = isSorted;
+  }
+}
+
+CURVEBALLSIDE autoSelectCurveballSide()
+{
+  // Trades along the side with fewer nodes move more edges each, as their
+  //  lists are longer on average
+  if ( graphInfo.nEvents < graphInfo.nActors ) {
+    return CURVEBALL_SIDE_EVENTS;
+  }
+  return CURVEBALL_SIDE_ACTORS;
+}
+
+void buildEventAdjLists(GRAPH* g)
+{
+  // Event-major lists from the actor lists, by the calling thread alone, so
+  //  that every event list is in ascending actor order and the trades that
+  //  follow do not depend on the thread scheduling
+  if ( g->eventAccumulatedDegrees[graphInfo.nEvents] != graphInfo.nEdges ) {
+    setEventAccumulatedDegrees( g ); // First use of this graph
+  }
+  for (uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
+    g->eventListsFill[eventIt] = g->eventAccumulatedDegrees[eventIt];
+  }
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    transposeActorAdjList( g, actorIt );
+  }
+  g->sortedEventAdjLists = TRUE;
+  g->currentEventAdjLists = TRUE;
+}
+
+bool actorAdjListsFromEventAdjLists(GRAPH* g, SCRATCHARENA* arena)
+{
+  // Inverse of buildEventAdjLists(), after event-side trades: actor degrees
+  //  are kept by the trades, so every edge keeps its actor (actorEdgeMaps)
+  //  and only the events are rewritten, in ascending order. The edge index
+  //  of every event list entry is updated on the way, so both orientations
+  //  are current and no co-occurrence engine needs to sort or transpose
+  const size_t arenaStart = arenaMark(arena);
+  uint* actorListsFill;
+  arenaArray(actorListsFill, arena, graphInfo.nActors);
+  if ( actorListsFill == NULL ) { MEM_ERROR; }
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    actorListsFill[actorIt] = g->actorAccumulatedDegrees[actorIt];
+  }
+  for (uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
+    for (uint listIt = g->eventAccumulatedDegrees[eventIt];
+         listIt < g->eventAccumulatedDegrees[eventIt+1]; listIt++) {
+      uint edgeIt = actorListsFill[ g->eventAdjLists[listIt] ]++;
+      g->actorAdjLists[edgeIt] = eventIt;
+      g->eventEdgeIndexes[listIt] = edgeIt;
+    }
+  }
+  arenaRelease(arena, arenaStart);
+  g->sortedActorAdjLists = TRUE;
+  g->currentEventAdjLists = TRUE;
+  g->staleActorAdjLists = FALSE;
+
+  return SUCCESS;
+}
+
+bool needsActorAdjListsAfterTrades()
+{
+  // Whether the actor lists are read between two sets of event-side trades
+  // The bit matrix engine reads the adj. matrix only, which is rebuilt from
+  //  the event lists as well (see adjMatrixFromAdjLists()). The sparse
+  //  product rows, of the fused and persistent statistics, walk both
+  //  orientations, and the pipeline snapshots copy the actor lists
+  return !(    settings.coocEngine == COOC_ENGINE_BITMATRIX
+            && !settings.fusedStats && !settings.pipelinedSampling );
+}
+
+bool needsAdjMatrixAfterTrades()
+{
+  // Whether the adj. matrix is read between two sets of trades, which do
+  //  not keep it: the bit matrix engine (also through the pipeline
+  //  snapshots, which copy it) and the swap heuristic take the
+  //  co-occurrence from it. The full graph test rebuilds it itself
+  return (    ( settings.coocEngine == COOC_ENGINE_BITMATRIX
+                && !settings.fusedStats )
+           || settings.runSwapHeuristic );
+}
+
+static inline uint nextStampEpochs(TRADESCRATCH* scratch)
+{
+  // Two epochs per trade: "in A1" (returned) and "in A1 and A2" (returned+1)
+  if ( scratch->stampEpoch >= UINT_MAX - 2 ) {
+    memset(scratch->eventStamps, 0, nTradeListIds() * sizeof(uint));
+    scratch->stampEpoch = 0;
+  }
+  scratch->stampEpoch += 2;
+  return scratch->stampEpoch - 1;
+}
+
+static uint markCommonEventsByStamps(const uint* A1, uint lengthA1,
+                                     const uint* A2, uint lengthA2,
+                                     uint8_t* isCommonA1, uint8_t* isCommonA2,
+                                     TRADESCRATCH* scratch)
+{
+  // Same result as markCommonEntries(), with one random access per event
+  //  instead of the ordered comparisons
+  memset(isCommonA1, 0, (lengthA1 + 7) / 8);
+  memset(isCommonA2, 0, (lengthA2 + 7) / 8);
+  uint* eventStamps = scratch->eventStamps;
+  const uint inA1 = nextStampEpochs(scratch);
+  const uint inBoth = inA1 + 1;
+  for (uint A1Idx = 0; A1Idx < lengthA1; ++A1Idx) {
+    eventStamps[ A1[A1Idx] ] = inA1;
+  }
+  uint nCommon = 0;
+  for (uint A2Idx = 0; A2Idx < lengthA2; ++A2Idx) {
+    if ( eventStamps[ A2[A2Idx] ] == inA1 ) {
+      eventStamps[ A2[A2Idx] ] = inBoth;
+      isCommonA2[A2Idx / 8] |= (uint8_t)( 1u << (A2Idx % 8) );
+      ++nCommon;
+    }
+  }
+  for (uint A1Idx = 0; A1Idx < lengthA1; ++A1Idx) {
+    if ( eventStamps[ A1[A1Idx] ] == inBoth ) {
+      isCommonA1[A1Idx / 8] |= (uint8_t)( 1u << (A1Idx % 8) );
+    }
+  }
+  return nCommon;
+}
+
+static inline uint markCommonEvents(const uint* A1, uint lengthA1,
+                                    const uint* A2, uint lengthA2,
+                                    uint8_t* isCommonA1, uint8_t* isCommonA2,
+                                    TRADESCRATCH* scratch)
+{
+  // The adaptive kernel picks the method by the lengths of the actor pair
+  //  (see calibrateTradeKernels()); the set intersection kernel itself
+  //  switches to galloping for very unequal lengths
+  if ( settings.curveballKernel == CURVEBALL_KERNEL_ADAPTIVE
+       && lengthA1 + lengthA2 >= tradeStampMinLength ) {
+    return markCommonEventsByStamps(A1, lengthA1, A2, lengthA2,
+                                    isCommonA1, isCommonA2, scratch);
+  }
+  return markCommonEntries(A1, lengthA1, A2, lengthA2, isCommonA1, isCommonA2);
+}
+
+bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                               TRADESCRATCH* scratch)
 {
   // 1. Finds the events that are unique to each actor (the swapping pool),
-  //      i.e. A1\A2 U A2\A1
+  //      i.e. A1\A2 U A2\A1, and the events common to both
   //    ASSUMES: Adjacent lists A1 and A2 are sorted in ascending order
-  // 2. Randomly shuffles the pool and reassign event IDs to lists
-  // 3. Sort lists
-
-  // "Rename" actor adjacency lists
-  uint* A1 = &g->actorAdjLists[ g->actorAccumulatedDegrees[ actorIds[0] ] ];
-  uint* A2 = &g->actorAdjLists[ g->actorAccumulatedDegrees[ actorIds[1] ] ];
+  // 2. Randomly draws which pool events go to each list
+  // 3. Refills the lists by merging, so they are left sorted in ascending order
 
-  // Get lists' length
-  uint lengthA1 = g->actorAccumulatedDegrees[ actorIds[0]+1 ];
-  lengthA1 -= g->actorAccumulatedDegrees[ actorIds[0] ];
-  uint lengthA2 = g->actorAccumulatedDegrees[ actorIds[1]+1 ];
-  lengthA2 -= g->actorAccumulatedDegrees[ actorIds[1] ];
+  // "Rename" adjacency lists of the traded side (see tradeAdjList())
+  uint lengthA1, lengthA2;
+  uint* A1 = tradeAdjList(g, actorIds[0], &lengthA1);
+  uint* A2 = tradeAdjList(g, actorIds[1], &lengthA2);
 
   #if PRINT_CURVEBALL_STEPS
   {
@@ -275,16 +752,40 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
     fprintf(curveballDebugFile, "]\n");
     fclose(curveballDebugFile);
   }
-  bool changedPool = FALSE;
   #endif
 
+  // Temporary arrays are taken from the arena of the calling thread
+  SCRATCHARENA* arena = scratch->arena;
+  const size_t arenaStart = arenaMark(arena);
   // A1\A2 U A2\A1 -> pool
   //  pool contains the event IDs that can end up in either A1 or A2
-  uint pool[lengthA1+lengthA2];
+  uint* pool;
+  arenaArray(pool, arena, lengthA1+lengthA2);
   // Ai\Aj -> Ai elements that are in the pool
   //  inPoolAi contains the index of Ai that can be swapped
-  uint inPoolA1[lengthA1];
-  uint inPoolA2[lengthA2];
+  uint* inPoolA1;
+  arenaArray(inPoolA1, arena, lengthA1);
+  uint* inPoolA2;
+  arenaArray(inPoolA2, arena, lengthA2);
+  // A1 ∩ A2 -> common, which stay in both lists
+  uint* common;
+  arenaArray(common, arena, min(lengthA1, lengthA2));
+  // Events of each list that are also in the other one
+  uint8_t* isCommonA1;
+  arenaArray(isCommonA1, arena, (lengthA1 + 7) / 8);
+  uint8_t* isCommonA2;
+  arenaArray(isCommonA2, arena, (lengthA2 + 7) / 8);
+  // Pool positions drawn to the list with the smaller in-pool part
+  uint* poolPositions;
+  arenaArray(poolPositions, arena, lengthA1+lengthA2);
+  bool* isDrawn;
+  arenaArray(isDrawn, arena, lengthA1+lengthA2);
+  if (    pool == NULL || inPoolA1 == NULL || inPoolA2 == NULL
+       || common == NULL || isCommonA1 == NULL || isCommonA2 == NULL
+       || poolPositions == NULL || isDrawn == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
 
   // Array iteration helpers
   uint A1Idx = 0;
@@ -292,107 +793,46 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
   uint poolIdx = 0;
   uint inPoolA1Idx = 0;
   uint inPoolA2Idx = 0;
+  uint nCommon = 0;
 
   // Build pool
   startTimer(&poolTimer);
-  // Ordered search of different eventIds in adj. lists
-  while ( A1Idx < lengthA1 && A2Idx < lengthA2 ) {
-    if ( A1[A1Idx] < A2[A2Idx] ) {
-      // If eventId in A1 is lower than eventId in A2, at that to the pool
-      #if PRINT_CURVEBALL_STEPS
-      {
-        FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-        fprintf(curveballDebugFile,
-                "Adding event %u to the pool from A1.\n", A1[A1Idx]);
-        fclose(curveballDebugFile);
-        changedPool = TRUE;
-      }
-      #endif
-      pool[poolIdx++] = A1[A1Idx];
-      inPoolA1[inPoolA1Idx++] = A1Idx;
-      ++A1Idx;
-    } else if ( A2[A2Idx] < A1[A1Idx] ) {
-      // If eventId in A2 is lower than eventId in A1, at that to the pool
-      #if PRINT_CURVEBALL_STEPS
-      {
-        FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-        fprintf(curveballDebugFile,
-                "Adding event %u to the pool from A2.\n", A2[A2Idx]);
-        fclose(curveballDebugFile);
-        changedPool = TRUE;
-      }
-      #endif
-      pool[poolIdx++] = A2[A2Idx];
-      inPoolA2[inPoolA2Idx++] = A2Idx;
-      ++A2Idx;
+  // The events of both lists are marked by the set intersection kernel, so
+  //  that only the events of the pool are left to be merged
+  uint nCommonMarked = markCommonEvents(A1, lengthA1, A2, lengthA2,
+                                        isCommonA1, isCommonA2, scratch);
+  for ( A1Idx = 0; A1Idx < lengthA1; ++A1Idx ) {
+    if ( isMarkedEntry(isCommonA1, A1Idx) ) {
+      common[nCommon++] = A1[A1Idx];
     } else {
-      // If both eventIds are equal, dont add to the pool
-      #if PRINT_CURVEBALL_STEPS
-      {
-        FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-        fprintf(curveballDebugFile,
-                "Not adding event %u to the pool.\n", A1[A1Idx]);
-        fclose(curveballDebugFile);
-        changedPool = FALSE;
-      }
-      #endif
-      ++A1Idx;
-      ++A2Idx;
-    }
-    #if PRINT_CURVEBALL_STEPS
-    {
-      if ( changedPool ) {
-        FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-        fprintf(curveballDebugFile, "Pool: [ ");
-        for( uint i=0; i < poolIdx; ++i ) {
-          fprintf(curveballDebugFile, "%u ", pool[i]);
-        }
-        fprintf(curveballDebugFile, "]\n");
-
-        fprintf(curveballDebugFile, "inPoolA1: [ ");
-        for( uint i=0; i < inPoolA1Idx; ++i ) {
-          fprintf(curveballDebugFile, "%u ", inPoolA1[i]);
-        }
-        fprintf(curveballDebugFile, "]\n");
-
-        fprintf(curveballDebugFile, "inPoolA2: [ ");
-        for( uint i=0; i < inPoolA2Idx; ++i ) {
-          fprintf(curveballDebugFile, "%u ", inPoolA2[i]);
-        }
-        fprintf(curveballDebugFile, "]\n");
-        fprintf(curveballDebugFile, "\n");
-        fclose(curveballDebugFile);
-      }
-      changedPool = FALSE;
+      inPoolA1[inPoolA1Idx++] = A1Idx;
     }
-    #endif
   }
-  // Add all remaining elements of the unfinished list to the pool
-  for( ; A1Idx < lengthA1; ++A1Idx ) {
-    #if PRINT_CURVEBALL_STEPS
-    {
-      FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-      fprintf(curveballDebugFile,
-              "Adding event %u to the pool from A1 end.\n", A1[A1Idx]);
-      fclose(curveballDebugFile);
-      changedPool = TRUE;
+  for ( A2Idx = 0; A2Idx < lengthA2; ++A2Idx ) {
+    if ( !isMarkedEntry(isCommonA2, A2Idx) ) {
+      inPoolA2[inPoolA2Idx++] = A2Idx;
     }
-    #endif
-    pool[poolIdx++] = A1[A1Idx];
-    inPoolA1[inPoolA1Idx++] = A1Idx;
   }
-  for( ; A2Idx < lengthA2; ++A2Idx ) {
-    #if PRINT_CURVEBALL_STEPS
-    {
-      FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-      fprintf(curveballDebugFile,
-              "Adding event %u to the pool from A2 end.\n", A2[A2Idx]);
-      fclose(curveballDebugFile);
-      changedPool = TRUE;
+  // Ordered merge of A1\A2 and A2\A1, which have no event in common
+  uint fromA1Idx = 0;
+  uint fromA2Idx = 0;
+  while ( fromA1Idx < inPoolA1Idx && fromA2Idx < inPoolA2Idx ) {
+    uint eventA1 = A1[ inPoolA1[fromA1Idx] ];
+    uint eventA2 = A2[ inPoolA2[fromA2Idx] ];
+    if ( eventA1 < eventA2 ) {
+      pool[poolIdx++] = eventA1;
+      ++fromA1Idx;
+    } else {
+      pool[poolIdx++] = eventA2;
+      ++fromA2Idx;
     }
-    #endif
-    pool[poolIdx++] = A2[A2Idx];
-    inPoolA2[inPoolA2Idx++] = A2Idx;
+  }
+  // Add all remaining elements of the unfinished part to the pool
+  for( ; fromA1Idx < inPoolA1Idx; ++fromA1Idx ) {
+    pool[poolIdx++] = A1[ inPoolA1[fromA1Idx] ];
+  }
+  for( ; fromA2Idx < inPoolA2Idx; ++fromA2Idx ) {
+    pool[poolIdx++] = A2[ inPoolA2[fromA2Idx] ];
   }
   accElapsedTime(&poolTimer);
 
@@ -400,11 +840,19 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
   uint nA1EventsInPool = inPoolA1Idx;
   uint nA2EventsInPool = inPoolA2Idx;
   // Sanity check
+  if ( nCommon != nCommonMarked ) {
+    STDERR_INFO("Number of events in both adjacency lists (%u) differs from "
+                "the number marked by the set intersection (%u).",
+                nCommon, nCommonMarked);
+    arenaRelease(arena, arenaStart);
+    RETURN_ERROR;
+  }
   if ( poolSize != nA1EventsInPool + nA2EventsInPool ) {
     STDERR_INFO("Total size of the swapping pool (%u) should be equal to "
                 "the sum of the number of elements in the two actor's "
                 "adjacency lists (%u + %u = %u).", poolSize, nA1EventsInPool,
                 nA2EventsInPool, nA1EventsInPool + nA2EventsInPool);
+    arenaRelease(arena, arenaStart);
     RETURN_ERROR;
   }
 
@@ -432,36 +880,31 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
   }
   #endif
 
-  // Shuffling the pool results in the same as randomly selecting each event ID
+  // The pool is sorted as well, as it was built by merging both lists
+  // Drawing a random subset of the pool positions, as large as the smaller
+  //  in-pool part, results in the same as randomly selecting each event ID
+  // Positions are shuffled instead of the pool itself, so it stays sorted
   startTimer(&shuffleTimer);
-//  shuffle(pool, poolSize, thisRandG);
-
-  //LessOrEqual Events of A1 are in the Pool
-  if(nA1EventsInPool <= nA2EventsInPool){
-    #if PRINT_SHUFFLE_STEPS
-      FILE* curveballDebugFile = fopen("curveball.dbg","a");
-      fprintf(curveballDebugFile,"Start shuffling with nA1 <= nA2\n");
-      fclose(curveballDebugFile);
-    #endif
-    shufflePartial(pool, poolSize, thisRandG, nA1EventsInPool);
+  bool isA1Smaller = ( nA1EventsInPool <= nA2EventsInPool );
+  uint nDrawnEvents = isA1Smaller ? nA1EventsInPool : nA2EventsInPool;
+  for( uint poolIdx = 0; poolIdx < poolSize; ++poolIdx ) {
+    poolPositions[poolIdx] = poolIdx;
+    isDrawn[poolIdx] = FALSE;
   }
-  //Less Events of A2 are in the Pool
-  else{
-    #if PRINT_SHUFFLE_STEPS
-      FILE* curveballDebugFile = fopen("curveball.dbg","a");
-      fprintf(curveballDebugFile,"Start shuffling with nA2 < nA1\n");
-      fclose(curveballDebugFile);
-    #endif
-    shufflePartial(pool, poolSize, thisRandG, nA2EventsInPool);
+  shufflePartial(poolPositions, poolSize, thisRandG, nDrawnEvents);
+  for( uint drawnIdx = 0; drawnIdx < nDrawnEvents; ++drawnIdx ) {
+    isDrawn[ poolPositions[drawnIdx] ] = TRUE;
   }
   accElapsedTime(&shuffleTimer);
 
   #if PRINT_CURVEBALL_STEPS
   {
     FILE* curveballDebugFile = fopen("curveball.dbg", "a");
-    fprintf(curveballDebugFile, "Shuffled Pool: [ ");
+    fprintf(curveballDebugFile, "Drawn to %s: [ ", isA1Smaller ? "A1" : "A2");
     for( uint i=0; i < poolSize; ++i ) {
-      fprintf(curveballDebugFile, "%u ", pool[i]);
+      if ( isDrawn[i] ) {
+        fprintf(curveballDebugFile, "%u ", pool[i]);
+      }
     }
     fprintf(curveballDebugFile, "]\n");
     fclose(curveballDebugFile);
@@ -470,20 +913,72 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
 
   // "Refill" adjacency lists
   startTimer(&refillTimer);
-  inPoolA1Idx = 0;
-  for( uint poolIdx = 0; poolIdx < nA1EventsInPool; ++poolIdx ) {
-    A1[ inPoolA1[inPoolA1Idx++] ] = pool[poolIdx];
+  if ( g->cooc != NULL ) {
+    // Incremental co-occurrence: every event leaving a list is replaced by
+    //  one entering it, at any position, before the lists are rewritten
+    uint leavingA1Idx = 0, enteringA1Idx = 0;
+    uint leavingA2Idx = 0, enteringA2Idx = 0;
+    uint *leavingA1, *enteringA1, *leavingA2, *enteringA2;
+    arenaArray(leavingA1, arena, lengthA1);
+    arenaArray(enteringA1, arena, lengthA1);
+    arenaArray(leavingA2, arena, lengthA2);
+    arenaArray(enteringA2, arena, lengthA2);
+    if (    leavingA1 == NULL || enteringA1 == NULL
+         || leavingA2 == NULL || enteringA2 == NULL ) {
+      arenaRelease(arena, arenaStart);
+      MEM_ERROR;
+    }
+    inPoolA1Idx = 0;
+    inPoolA2Idx = 0;
+    for( uint poolIdx = 0; poolIdx < poolSize; ++poolIdx ) {
+      bool toA1 = ( isDrawn[poolIdx] == isA1Smaller );
+      bool fromA1 = ( inPoolA1Idx < nA1EventsInPool
+                      && A1[ inPoolA1[inPoolA1Idx] ] == pool[poolIdx] );
+      if ( fromA1 ) {
+        if ( !toA1 ) {
+          leavingA1[leavingA1Idx++] = inPoolA1[inPoolA1Idx];
+          enteringA2[enteringA2Idx++] = pool[poolIdx];
+        }
+        ++inPoolA1Idx;
+      } else {
+        if ( toA1 ) {
+          leavingA2[leavingA2Idx++] = inPoolA2[inPoolA2Idx];
+          enteringA1[enteringA1Idx++] = pool[poolIdx];
+        }
+        ++inPoolA2Idx;
+      }
+    }
+    for( uint moveIdx = 0; moveIdx < leavingA1Idx; ++moveIdx ) {
+      coocReplaceListEntry(g->cooc, A1, lengthA1,
+                           leavingA1[moveIdx], enteringA1[moveIdx]);
+      coocReplaceListEntry(g->cooc, A2, lengthA2,
+                           leavingA2[moveIdx], enteringA2[moveIdx]);
+    }
   }
-  inPoolA2Idx = 0;
-  for( uint poolIdx = nA1EventsInPool; poolIdx < poolSize; ++poolIdx ) {
-    A2[ inPoolA2[inPoolA2Idx++] ] = pool[poolIdx];
+
+  // Both lists merge the common events with the pool events they end up with
+  A1Idx = 0;
+  A2Idx = 0;
+  uint commonA1Idx = 0;
+  uint commonA2Idx = 0;
+  for( uint poolIdx = 0; poolIdx < poolSize; ++poolIdx ) {
+    uint eventId = pool[poolIdx];
+    if ( isDrawn[poolIdx] == isA1Smaller ) {
+      while ( commonA1Idx < nCommon && common[commonA1Idx] < eventId ) {
+        A1[A1Idx++] = common[commonA1Idx++];
+      }
+      A1[A1Idx++] = eventId;
+    } else {
+      while ( commonA2Idx < nCommon && common[commonA2Idx] < eventId ) {
+        A2[A2Idx++] = common[commonA2Idx++];
+      }
+      A2[A2Idx++] = eventId;
+    }
   }
+  while ( commonA1Idx < nCommon ) { A1[A1Idx++] = common[commonA1Idx++]; }
+  while ( commonA2Idx < nCommon ) { A2[A2Idx++] = common[commonA2Idx++]; }
   accElapsedTime(&refillTimer);
-
-  startTimer(&sortListsTimer);
-  qsort(A1, lengthA1, sizeof(uint), cmpfunc);
-  qsort(A2, lengthA2, sizeof(uint), cmpfunc);
-  accElapsedTime(&sortListsTimer);
+  arenaRelease(arena, arenaStart);
 
   #if PRINT_CURVEBALL_STEPS
   {
@@ -506,44 +1001,33 @@ bool curveballTradeSortedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
 
 }
 
-POOL_HASH* addEventToPool(POOL_HASH* poolHash, uint idx, uint eventId) {
-  POOL_HASH* newItem; // Create and allocate a new item for the @pool table
-  newItem = (POOL_HASH*)calloc(1, sizeof(POOL_HASH));
-  if ( newItem != NULL ) {
-    newItem->eventId = eventId;
-    newItem->listIndex = idx;
-    HASH_ADD_INT(poolHash, eventId, newItem);
-  }
-  else {
-    STDERR_INFO("Unable to allocate new item to hash table.\n"
-                "Intended key: %u, and value: %u.", idx, eventId);
-    RETURN_ERROR_V(NULL);
-  }
+POOL_HASH* addEventToPool(POOL_HASH* poolHash, POOL_HASH* newItem,
+                          uint idx, uint eventId) {
+  // @newItem is taken from the scratch arena by the caller
+  newItem->eventId = eventId;
+  newItem->listIndex = idx;
+  HASH_ADD_INT(poolHash, eventId, newItem);
   return poolHash; // Return new pointer to the hash structure
 }
 
 POOL_HASH* deleteEventFromPool(POOL_HASH* poolHash, POOL_HASH* eventItem) {
+  // The item itself is released with the scratch arena of the trade
   HASH_DEL(poolHash, eventItem);
-  free(eventItem);
   return poolHash; // Return new pointer to the hash structure
 }
 
-bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
+bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                               TRADESCRATCH* scratch)
 {
   // 1. Finds the events that are unique to each actor (the swapping pool),
   //      i.e. A1\A2 U A2\A1
   // 2. Randomly shuffles the pool and reassign event IDs to lists
   // 3. Sort lists
 
-  // "Rename" actor adjacency lists
-  uint* A1 = &g->actorAdjLists[ g->actorAccumulatedDegrees[ actorIds[0] ] ];
-  uint* A2 = &g->actorAdjLists[ g->actorAccumulatedDegrees[ actorIds[1] ] ];
-
-  // Get lists' length
-  uint lengthA1 = g->actorAccumulatedDegrees[ actorIds[0]+1 ];
-  lengthA1 -= g->actorAccumulatedDegrees[ actorIds[0] ];
-  uint lengthA2 = g->actorAccumulatedDegrees[ actorIds[1]+1 ];
-  lengthA2 -= g->actorAccumulatedDegrees[ actorIds[1] ];
+  // "Rename" adjacency lists of the traded side (see tradeAdjList())
+  uint lengthA1, lengthA2;
+  uint* A1 = tradeAdjList(g, actorIds[0], &lengthA1);
+  uint* A2 = tradeAdjList(g, actorIds[1], &lengthA2);
 
   #if PRINT_CURVEBALL_STEPS
   {
@@ -562,12 +1046,20 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
   }
   #endif
 
+  // Hash items and temporary arrays are taken from the arena of the
+  //  calling thread, one item per list entry
+  SCRATCHARENA* arena = scratch->arena;
+  const size_t arenaStart = arenaMark(arena);
+  POOL_HASH* poolItems;
+  arenaArray(poolItems, arena, lengthA1+lengthA2);
+  if ( poolItems == NULL ) { MEM_ERROR; }
+
   // Build hashed pool
   startTimer(&hashedPoolTimer);
   POOL_HASH* hashedPool = NULL;
   for (uint A1Idx = 0; A1Idx < lengthA1; ++A1Idx) {
-    hashedPool = addEventToPool(hashedPool, A1Idx, A1[A1Idx]);
-    if ( hashedPool == NULL ) { FORWARD_ERROR; }
+    hashedPool = addEventToPool(hashedPool, &poolItems[A1Idx],
+                                A1Idx, A1[A1Idx]);
     #if PRINT_CURVEBALL_STEPS
     {
       FILE* curveballDebugFile = fopen("curveball.dbg", "a");
@@ -592,8 +1084,8 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
       --nA1EventsInPool;
     } else { // Is only in A2
       // Use @lengthA1 as safe offset for index in the pool
-      hashedPool = addEventToPool(hashedPool, A2Idx + lengthA1, A2[A2Idx]);
-      if ( hashedPool == NULL ) { FORWARD_ERROR; }
+      hashedPool = addEventToPool(hashedPool, &poolItems[A2Idx + lengthA1],
+                                  A2Idx + lengthA1, A2[A2Idx]);
       ++nA2EventsInPool;
     }
     #if PRINT_CURVEBALL_STEPS
@@ -616,6 +1108,7 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
                 "the sum of the number of elements in the two actor's "
                 "adjacency lists (%u + %u != %u).", poolSize, nA1EventsInPool,
                 nA2EventsInPool, poolSize);
+    arenaRelease(arena, arenaStart);
     RETURN_ERROR;
   }
   accElapsedTime(&hashedPoolTimer);
@@ -624,14 +1117,21 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
   startTimer(&poolTimer);
   // A1\A2 U A2\A1 -> pool
   //  pool contains the event IDs that can end up in either A1 or A2
-  uint pool[poolSize];
+  uint* pool;
+  arenaArray(pool, arena, poolSize);
   uint poolIdx = 0;
   // Ai\Aj -> Ai elements that are in the pool
   //  inPoolAi contains the index of Ai that can be swapped
-  uint inPoolA1[nA1EventsInPool];
+  uint* inPoolA1;
+  arenaArray(inPoolA1, arena, nA1EventsInPool);
   uint inPoolA1Idx = 0;
-  uint inPoolA2[nA2EventsInPool];
+  uint* inPoolA2;
+  arenaArray(inPoolA2, arena, nA2EventsInPool);
   uint inPoolA2Idx = 0;
+  if ( pool == NULL || inPoolA1 == NULL || inPoolA2 == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
 
   // Iterates through the hashed pool to fill in its vectorized structures
   POOL_HASH *currentItem, *helperItem;
@@ -718,15 +1218,19 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
 
   // "Refill" adjacency lists
   startTimer(&refillTimer);
+  setSortedTradeLists(g, FALSE); // Pool events land in random order
   inPoolA1Idx = 0;
+  inPoolA2Idx = 0;
   for( uint poolIdx = 0; poolIdx < nA1EventsInPool; ++poolIdx ) {
-    A1[ inPoolA1[inPoolA1Idx++] ] = pool[poolIdx];
+    setTradeListEntry(g, A1, lengthA1, inPoolA1[inPoolA1Idx++],
+                      pool[poolIdx], scratch);
   }
-  inPoolA2Idx = 0;
   for( uint poolIdx = nA1EventsInPool; poolIdx < poolSize; ++poolIdx ) {
-    A2[ inPoolA2[inPoolA2Idx++] ] = pool[poolIdx];
+    setTradeListEntry(g, A2, lengthA2, inPoolA2[inPoolA2Idx++],
+                      pool[poolIdx], scratch);
   }
   accElapsedTime(&refillTimer);
+  arenaRelease(arena, arenaStart);
 
   #if PRINT_CURVEBALL_STEPS
   {
@@ -749,26 +1253,424 @@ bool curveballTradeHashedLists(GRAPH* g, uint* actorIds, gsl_rng* thisRandG)
 
 }
 
+bool curveballTradeStampedLists(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                                TRADESCRATCH* scratch)
+{
+  // Same trade as curveballTradeHashedLists(), with the pool built from
+  //  stamps of the events of each list, and only the smaller in-pool part
+  //  shuffled in. Uses only the preallocated @scratch of the calling thread.
+
+  // "Rename" adjacency lists of the traded side (see tradeAdjList())
+  uint lengthA1, lengthA2;
+  uint* A1 = tradeAdjList(g, actorIds[0], &lengthA1);
+  uint* A2 = tradeAdjList(g, actorIds[1], &lengthA2);
+
+  SCRATCHARENA* arena = scratch->arena;
+  const size_t arenaStart = arenaMark(arena);
+  uint* pool;
+  arenaArray(pool, arena, lengthA1+lengthA2);
+  uint* inPoolA1;
+  arenaArray(inPoolA1, arena, lengthA1);
+  uint* inPoolA2;
+  arenaArray(inPoolA2, arena, lengthA2);
+  if ( pool == NULL || inPoolA1 == NULL || inPoolA2 == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
+  uint* eventStamps = scratch->eventStamps;
+
+  // Build pool
+  startTimer(&poolTimer);
+  const uint inA1 = nextStampEpochs(scratch);
+  const uint inBoth = inA1 + 1;
+  for (uint A1Idx = 0; A1Idx < lengthA1; ++A1Idx) {
+    eventStamps[ A1[A1Idx] ] = inA1;
+  }
+  uint nA2EventsInPool = 0;
+  for (uint A2Idx = 0; A2Idx < lengthA2; ++A2Idx) {
+    if ( eventStamps[ A2[A2Idx] ] == inA1 ) {
+      eventStamps[ A2[A2Idx] ] = inBoth;
+    } else {
+      inPoolA2[nA2EventsInPool++] = A2Idx;
+    }
+  }
+  // Pool in the same order as the hashed one: A1\A2, then A2\A1
+  uint poolSize = 0;
+  uint nA1EventsInPool = 0;
+  for (uint A1Idx = 0; A1Idx < lengthA1; ++A1Idx) {
+    if ( eventStamps[ A1[A1Idx] ] == inA1 ) {
+      inPoolA1[nA1EventsInPool++] = A1Idx;
+      pool[poolSize++] = A1[A1Idx];
+    }
+  }
+  for (uint inPoolA2Idx = 0; inPoolA2Idx < nA2EventsInPool; ++inPoolA2Idx) {
+    pool[poolSize++] = A2[ inPoolA2[inPoolA2Idx] ];
+  }
+  accElapsedTime(&poolTimer);
+
+  #if PRINT_CURVEBALL_STEPS
+  {
+    FILE* curveballDebugFile = fopen("curveball.dbg", "a");
+    fprintf(curveballDebugFile, "Stamped pool (%u from A1, %u from A2): [ ",
+            nA1EventsInPool, nA2EventsInPool);
+    for( uint i=0; i < poolSize; ++i ) {
+      fprintf(curveballDebugFile, "%u ", pool[i]);
+    }
+    fprintf(curveballDebugFile, "]\n");
+    fclose(curveballDebugFile);
+  }
+  #endif
+
+  // A random subset as large as the smaller in-pool part is shuffled into the
+  //  front of the pool, and goes to the list with the smaller in-pool part
+  startTimer(&shuffleTimer);
+  bool isA1Smaller = ( nA1EventsInPool <= nA2EventsInPool );
+  shufflePartial(pool, poolSize, thisRandG,
+                 isA1Smaller ? nA1EventsInPool : nA2EventsInPool);
+  accElapsedTime(&shuffleTimer);
+  const uint* poolToA1 = isA1Smaller ? pool : &pool[nA2EventsInPool];
+  const uint* poolToA2 = isA1Smaller ? &pool[nA1EventsInPool] : pool;
+
+  // "Refill" adjacency lists
+  startTimer(&refillTimer);
+  setSortedTradeLists(g, FALSE); // Pool events land in random order
+  for( uint poolIdx = 0; poolIdx < nA1EventsInPool; ++poolIdx ) {
+    setTradeListEntry(g, A1, lengthA1, inPoolA1[poolIdx],
+                      poolToA1[poolIdx], scratch);
+  }
+  for( uint poolIdx = 0; poolIdx < nA2EventsInPool; ++poolIdx ) {
+    setTradeListEntry(g, A2, lengthA2, inPoolA2[poolIdx],
+                      poolToA2[poolIdx], scratch);
+  }
+  accElapsedTime(&refillTimer);
+  arenaRelease(arena, arenaStart);
+
+  return SUCCESS;
+}
+
+bool curveballTrade(GRAPH* g, uint* actorIds, RANDGEN* thisRandG,
+                    TRADESCRATCH* scratch)
+{
+  scratch->checksumDelta = 0;
+
+  // Trade with the kernel of the settings (see "-curveballkernel")
+  bool tradeStatus;
+  if ( isSortedCurveballKernel() ) {
+    if ( isEventSideCurveball() ) {
+      if ( !g->sortedEventAdjLists ) { // First trade after an unsorting change
+        for (uint eventIt = 0; eventIt < graphInfo.nEvents; ++eventIt) {
+          qsort(&g->eventAdjLists[ g->eventAccumulatedDegrees[eventIt] ],
+                g->eventAccumulatedDegrees[eventIt+1]
+                - g->eventAccumulatedDegrees[eventIt],
+                sizeof(uint), cmpfunc);
+        }
+        g->sortedEventAdjLists = TRUE;
+      }
+    } else if ( !g->sortedActorAdjLists ) { // First trade after an unsorting change
+      for (uint actorIt = 0; actorIt < graphInfo.nActors; ++actorIt) {
+        sortActorAdjList(g, actorIt);
+      }
+      g->sortedActorAdjLists = TRUE;
+    }
+    tradeStatus = curveballTradeSortedLists(g, actorIds, thisRandG, scratch);
+  } else if ( settings.curveballKernel == CURVEBALL_KERNEL_STAMPED ) {
+    tradeStatus = curveballTradeStampedLists(g, actorIds, thisRandG, scratch);
+  } else {
+    setUthashArena(scratch->arena); // Table and buckets of the pool hash
+    tradeStatus = curveballTradeHashedLists(g, actorIds, thisRandG, scratch);
+    setUthashArena(NULL);
+  }
+
+  #if TEST_GRAPH_INVARIANTS
+  // The lists only exchange IDs, so the delta of a correct trade is zero.
+  //  Any other one is kept in the degree checksum of the other side, which
+  //  the concurrent trades of a global curveball round share (see
+  //  checkGraphInvariants())
+  if ( scratch->checksumDelta != 0 ) {
+    ulint* checksum = isEventSideCurveball() ? &g->actorDegreesChecksum
+                                             : &g->eventDegreesChecksum;
+    __atomic_fetch_add(checksum, scratch->checksumDelta, __ATOMIC_RELAXED);
+  }
+  #endif
+
+  return tradeStatus;
+}
+
+bool isSortedCurveballKernel()
+{
+  // Kernels that need, and keep, the actor lists sorted
+  return (    settings.curveballKernel == CURVEBALL_KERNEL_SORTED
+           || settings.curveballKernel == CURVEBALL_KERNEL_ADAPTIVE );
+}
+
+static void drawSortedList(uint* list, uint length, uint nValues,
+                           uint8_t* isDrawn, RANDGEN* thisRandG)
+{
+  // Floyd's sampling: @length distinct values of [0, @nValues), in
+  //  O(@length) draws, then sorted. @isDrawn is a zeroed bitmap of
+  //  @nValues bits, left zeroed again
+  for (uint nSelected = 0; nSelected < length; ++nSelected) {
+    uint last = nValues - length + nSelected;
+    uint value = randUniformInt(thisRandG, last + 1);
+    if ( isDrawn[value / 8] & (1u << (value % 8)) ) {
+      value = last;
+    }
+    isDrawn[value / 8] |= (uint8_t)( 1u << (value % 8) );
+    list[nSelected] = value;
+  }
+  qsort(list, length, sizeof(uint), cmpfunc);
+  for (uint listIt = 0; listIt < length; ++listIt) {
+    isDrawn[list[listIt] / 8] = 0;
+  }
+}
+
+static double timeMarkCommonEvents(const uint* listsA, uint lengthA,
+                                   const uint* listsB, uint lengthB,
+                                   uint nListPairs, uint8_t* isCommonA,
+                                   uint8_t* isCommonB, TRADESCRATCH* scratch,
+                                   bool useStamps)
+{
+  // Best of 3 runs, each over about TRADE_CALIBRATION_ENTRIES list entries
+  // The runs cycle through different list pairs, so that the branches are
+  //  not learned as they would be for a single pair
+  uint nRepetitions = max(1u, TRADE_CALIBRATION_ENTRIES
+                              / max(1u, lengthA + lengthB));
+  double bestTime = DBL_MAX;
+  for (uint runIt = 0; runIt < 3; ++runIt) {
+    TIMER calibrationTimer;
+    startTimer(&calibrationTimer);
+    for (uint repetitionIt = 0; repetitionIt < nRepetitions; ++repetitionIt) {
+      const uint* listA = &listsA[ (size_t)(repetitionIt % nListPairs)
+                                   * lengthA ];
+      const uint* listB = &listsB[ (size_t)(repetitionIt % nListPairs)
+                                   * lengthB ];
+      if ( useStamps ) {
+        markCommonEventsByStamps(listA, lengthA, listB, lengthB,
+                                 isCommonA, isCommonB, scratch);
+      } else {
+        markCommonEntries(listA, lengthA, listB, lengthB,
+                          isCommonA, isCommonB);
+      }
+    }
+    double runTime = getElapsedTime(&calibrationTimer);
+    if ( runTime < bestTime ) { bestTime = runTime; }
+  }
+  return bestTime;
+}
+
+static uint drawSortedListPairs(uint* listsA, uint lengthA,
+                                uint* listsB, uint lengthB,
+                                uint8_t* isDrawn, RANDGEN* thisRandG)
+{
+  // As many pairs as fit in the calibration work, up to
+  //  TRADE_CALIBRATION_LIST_PAIRS
+  uint nListPairs = max(1u, min((uint)TRADE_CALIBRATION_LIST_PAIRS,
+                                TRADE_CALIBRATION_ENTRIES
+                                / max(1u, lengthA + lengthB)));
+  for (uint pairIt = 0; pairIt < nListPairs; ++pairIt) {
+    drawSortedList(&listsA[ (size_t)pairIt * lengthA ], lengthA,
+                   nTradeListIds(), isDrawn, thisRandG);
+    drawSortedList(&listsB[ (size_t)pairIt * lengthB ], lengthB,
+                   nTradeListIds(), isDrawn, thisRandG);
+  }
+  return nListPairs;
+}
+
+bool calibrateTradeKernels(TRADESCRATCH* scratch)
+{
+  // Microbenchmarks of the pool construction methods of the adaptive kernel,
+  //  on random lists of this graph's events:
+  //  1. Lists of equal length L, by the set intersection kernel (no
+  //     galloping) and by event stamps: stamps are used from the first
+  //     total length 2L at which they are faster
+  //  2. Lists of lengths S and S*r, by block compares and by galloping:
+  //     galloping is used above half the first ratio r at which it is faster
+  // Drawn from a generator of their own, so that the samples do not depend
+  //  on the calibration
+  const uint nEvents = nTradeListIds(); // Actors, for event-side trades
+  const uint shortLength = 32;
+  // Enough for all the list pairs of any microbenchmark
+  const size_t listsSize = max((size_t)nEvents,
+                               (size_t)TRADE_CALIBRATION_ENTRIES);
+  uint* listsA;
+  uint* listsB;
+  uint8_t* isCommonA;
+  uint8_t* isCommonB;
+  uint8_t* isDrawn;
+  arrayCalloc(listsA, listsSize);
+  arrayCalloc(listsB, listsSize);
+  arrayCalloc(isCommonA, nEvents / 8 + 1);
+  arrayCalloc(isCommonB, nEvents / 8 + 1);
+  arrayCalloc(isDrawn, nEvents / 8 + 1);
+  RANDGEN* calibrationRandG = NULL;
+  if (    listsA != NULL && listsB != NULL && isCommonA != NULL
+       && isCommonB != NULL && isDrawn != NULL ) {
+    calibrationRandG = randGenAlloc(RNG_MT19937, 0, 0, 0);
+  }
+  if ( calibrationRandG == NULL ) {
+    free(listsA);
+    free(listsB);
+    free(isCommonA);
+    free(isCommonB);
+    free(isDrawn);
+    MEM_ERROR;
+  }
+
+  // 1. Block compares vs. event stamps
+  // Lengths that were not timed keep the compiled threshold
+  intersectionGallopRatio = UINT_MAX;
+  tradeStampMinLength = TRADE_STAMP_MIN_LENGTH;
+  for (uint length = 16; length <= nEvents / 2; length *= 2) {
+    tradeStampMinLength = UINT_MAX; // Timed, and never faster so far
+    uint nListPairs = drawSortedListPairs(listsA, length, listsB, length,
+                                          isDrawn, calibrationRandG);
+    double blocksTime = timeMarkCommonEvents(listsA, length, listsB, length,
+                                             nListPairs, isCommonA, isCommonB,
+                                             scratch, FALSE);
+    double stampsTime = timeMarkCommonEvents(listsA, length, listsB, length,
+                                             nListPairs, isCommonA, isCommonB,
+                                             scratch, TRUE);
+    if ( stampsTime < blocksTime ) {
+      tradeStampMinLength = 2 * length;
+      break;
+    }
+  }
+
+  // 2. Block compares vs. galloping
+  // Ratios that were not timed keep the compiled one
+  uint gallopRatio = INTERSECTION_GALLOP_RATIO;
+  uint ratio = 2;
+  for (; ratio <= 1024 && shortLength * ratio <= nEvents; ratio *= 2) {
+    uint longLength = shortLength * ratio;
+    uint nListPairs = drawSortedListPairs(listsA, shortLength,
+                                          listsB, longLength,
+                                          isDrawn, calibrationRandG);
+    intersectionGallopRatio = UINT_MAX;
+    double blocksTime = timeMarkCommonEvents(listsA, shortLength,
+                                             listsB, longLength, nListPairs,
+                                             isCommonA, isCommonB,
+                                             scratch, FALSE);
+    intersectionGallopRatio = 1;
+    double gallopTime = timeMarkCommonEvents(listsA, shortLength,
+                                             listsB, longLength, nListPairs,
+                                             isCommonA, isCommonB,
+                                             scratch, FALSE);
+    if ( gallopTime < blocksTime ) {
+      gallopRatio = ratio / 2;
+      break;
+    }
+    // Never faster in the tested range so far: gallop beyond it
+    gallopRatio = 2 * ratio;
+  }
+  intersectionGallopRatio = gallopRatio;
+
+  randGenFree(calibrationRandG);
+  free(listsA);
+  free(listsB);
+  free(isCommonA);
+  free(isCommonB);
+  free(isDrawn);
+
+  return SUCCESS;
+}
+
+static inline uint* coocPair(uint** cooc, uint eventId1, uint eventId2)
+{
+  // Position of the pair in the co-occurrence half matrix
+  if ( eventId1 > eventId2 ) {
+    uint tmp = eventId1;
+    eventId1 = eventId2;
+    eventId2 = tmp;
+  }
+  return &cooc[eventId1][eventId2 - eventId1 - 1];
+}
+
+void coocReplaceListEntry(uint** cooc, uint* list, uint length,
+                          uint position, uint newEventId)
+{
+  // Replaces list[position] by @newEventId, updating the co-occurrence of the
+  //  old and the new event with every other event of the list
+  // While a list is being refilled it may hold the same event twice: such
+  //  (self) pairs are skipped both when removing and when adding, so the
+  //  co-occurrence is exact once the list holds distinct events again
+  const uint oldEventId = list[position];
+  if ( oldEventId == newEventId ) { return; }
+
+  for (uint listIt = 0; listIt < length; ++listIt) {
+    if ( listIt == position ) { continue; }
+    const uint eventId = list[listIt];
+    if ( eventId != oldEventId ) {
+      --(*coocPair(cooc, oldEventId, eventId));
+    }
+    if ( eventId != newEventId ) {
+      ++(*coocPair(cooc, newEventId, eventId));
+    }
+  }
+  list[position] = newEventId;
+}
 /* **************************************** */
 
 /* **************************************** */
 /* Edge pairs' co-occurrence assessing related functions */
-void setIndexesOfSubBlocks (GRAPH* g, uint actorId)
+static inline uint subBlockUpperLimit(uint subBlockIt)
+{
+  // Maximun event ID value (exclusive) of the given sub-block
+  return (uint) ( ((ulint) subBlockIt + 1) * graphInfo.nEvents
+                  / coocSchedule.nSubBlocks );
+}
+
+void sortActorAdjList(GRAPH* g, uint actorId)
 {
-  // Sort actor adjacency list
   qsort(&(g->actorAdjLists[ g->actorAccumulatedDegrees[actorId] ]),
         g->actorAccumulatedDegrees[actorId+1] - g->actorAccumulatedDegrees[actorId],
         sizeof(uint),
         cmpfunc);
+}
 
-  // Define maximun event ID value for each sub-block
-  // This operation could be done only once
-  //  However, for the sake of clarity it is done for each co-occurrence computation
-  //  knowing that the overhead of doing so is irrelevant.
-  uint subBlockUpperLimit[NUMBER_OF_SUBBLOCKS];
-  for (uint subBlockIt = 0; subBlockIt < NUMBER_OF_SUBBLOCKS; subBlockIt++) {
-    subBlockUpperLimit[subBlockIt] = (subBlockIt + 1) * graphInfo.nEvents / NUMBER_OF_SUBBLOCKS;
+static inline uint lowerBoundInList(const uint* list, uint low, uint high,
+                                    uint eventId)
+{
+  // First index of the sorted list[low:high] whose event is not lower than
+  //  eventId (high if there is none)
+  while ( low < high ) {
+    uint middle = low + (high - low) / 2;
+    if ( list[middle] < eventId ) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
   }
+  return low;
+}
+
+static void setIndexesOfSubBlocksSorted (GRAPH* g, uint actorId)
+{
+  // Each sub-block ends at the first edge whose event is not lower than its
+  //  upper limit (binary search), and the next one starts there
+  uint subBlockStart = g->actorAccumulatedDegrees[actorId];
+  const uint actorListEnd = g->actorAccumulatedDegrees[actorId+1];
+  for (uint subBlockIt = 0; subBlockIt < coocSchedule.nSubBlocks; subBlockIt++) {
+    uint subBlockEnd = lowerBoundInList(g->actorAdjLists, subBlockStart,
+                                        actorListEnd,
+                                        subBlockUpperLimit(subBlockIt));
+    g->subBlocksStartIndexes[actorId][subBlockIt] = subBlockStart;
+    g->subBlocksEndIndexes[actorId][subBlockIt] = subBlockEnd;
+    subBlockStart = subBlockEnd;
+  }
+}
+
+void setIndexesOfSubBlocks (GRAPH* g, uint actorId)
+{
+  // Lists kept sorted by the randomization need no sorting
+  if ( g->sortedActorAdjLists ) {
+    setIndexesOfSubBlocksSorted(g, actorId);
+    return;
+  }
+
+  // Sort actor adjacency list
+  sortActorAdjList(g, actorId);
+
+  const uint nSubBlocks = coocSchedule.nSubBlocks;
 
   #if PRINT_SUB_BLOCKS_INDEXING_INFO
     char subBlockIndexingFileName[30 + MAX_INT_STR_SIZE];
@@ -806,7 +1708,7 @@ void setIndexesOfSubBlocks (GRAPH* g, uint actorId)
   }
   #endif
   for ( edgeIt = g->actorAccumulatedDegrees[actorId]; edgeIt < g->actorAccumulatedDegrees[actorId+1]; edgeIt++ ) {
-    if ( g->actorAdjLists[edgeIt] >= subBlockUpperLimit[subBlockIt] ) {
+    if ( g->actorAdjLists[edgeIt] >= subBlockUpperLimit(subBlockIt) ) {
       // End of current sub-block
       g->subBlocksEndIndexes[actorId][subBlockIt] = edgeIt;
       // Start of next sub-block
@@ -849,9 +1751,9 @@ void setIndexesOfSubBlocks (GRAPH* g, uint actorId)
   #endif
 
   // Important: make sure all sub-block indexes are updated for each graph
-  // If the next sub-block iterator is not greater than NUMBER_OF_SUBBLOCKS at this point,
+  // If the next sub-block iterator is not greater than nSubBlocks at this point,
   //  this means that the actor list does not contain any edges pertaining to the last sub-blocks
-  for (subBlockIt = subBlockIt + 1; subBlockIt < NUMBER_OF_SUBBLOCKS; subBlockIt++) {
+  for (subBlockIt = subBlockIt + 1; subBlockIt < nSubBlocks; subBlockIt++) {
     // Start of next sub-block
     g->subBlocksStartIndexes[actorId][subBlockIt] = edgeIt;
     // End of current sub-block
@@ -879,264 +1781,236 @@ void setIndexesOfSubBlocks (GRAPH* g, uint actorId)
 
 }
 
-void computeCooc(GRAPH* g, uint** cooc, int threadId) 
+
+bool initCoocSchedule(COOCSCHEDULE* schedule, uint nThreads)
 {
-  int i, j;
+  memset(schedule, 0, sizeof *schedule);
 
-  #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-  char threadCoocFileName[40];
-  char threadIdStr[MAX_INT_STR_SIZE];
-  strcpy(threadCoocFileName, "thread");
-  sprintf(threadIdStr, "%d", threadId);
-  strcat(threadCoocFileName, threadIdStr);
-  strcat(threadCoocFileName, "CoocFile.dbg");
-  FILE* threadCoocFile = fopen(threadCoocFileName, "a");
-  fprintf(threadCoocFile, "BEGIN GRAPH\n");
-  #endif
+  if ( nThreads == 0 ) { nThreads = 1; }
+  schedule->nThreads = nThreads;
 
+  // Smallest number of sub-blocks with enough tiles for all threads
+  schedule->nSubBlocks = 1;
+  while ( schedule->nSubBlocks * (schedule->nSubBlocks + 1) / 2
+          < COOC_TILES_PER_THREAD * nThreads ) {
+    schedule->nSubBlocks++;
+  }
+  schedule->nTiles = schedule->nSubBlocks * (schedule->nSubBlocks + 1) / 2;
 
-  switch (threadId) {
-    case 0 : //subBlock 0 with subBlock 0
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][0]; i < g->subBlocksEndIndexes[actorId][0] - 1; i++) {
-          for (j = i+1; j < g->subBlocksEndIndexes[actorId][0]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  arrayCalloc(schedule->tileSubBlocks1, schedule->nTiles);
+  if ( schedule->tileSubBlocks1 == NULL ) { MEM_ERROR; }
+  arrayCalloc(schedule->tileSubBlocks2, schedule->nTiles);
+  if ( schedule->tileSubBlocks2 == NULL ) { MEM_ERROR; }
+  arrayCalloc(schedule->tileCosts, schedule->nTiles);
+  if ( schedule->tileCosts == NULL ) { MEM_ERROR; }
+  arrayCalloc(schedule->tileOrder, schedule->nTiles);
+  if ( schedule->tileOrder == NULL ) { MEM_ERROR; }
 
-    case 1 : //subBlock 1 with subBlock 1
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][1]; i < g->subBlocksEndIndexes[actorId][1] - 1; i++) {
-          for (j = i+1; j < g->subBlocksEndIndexes[actorId][1]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  uint tileIt = 0;
+  for (uint sb1 = 0; sb1 < schedule->nSubBlocks; sb1++) {
+    for (uint sb2 = sb1; sb2 < schedule->nSubBlocks; sb2++) {
+      schedule->tileSubBlocks1[tileIt] = sb1;
+      schedule->tileSubBlocks2[tileIt] = sb2;
+      tileIt++;
+    }
+  }
 
-    case 2 : //subBlock 2 with subBlock 2
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][2]; i < g->subBlocksEndIndexes[actorId][2] - 1; i++) {
-          for (j = i+1; j < g->subBlocksEndIndexes[actorId][2]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  // Until the node degrees are known, tiles are dealt in their own order
+  for (tileIt = 0; tileIt < schedule->nTiles; tileIt++) {
+    schedule->tileCosts[tileIt] = 1;
+    schedule->tileOrder[tileIt] = tileIt;
+  }
 
-    case 3 : //subBlock 3 with subBlock 3
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][3]; i < g->subBlocksEndIndexes[actorId][3] - 1; i++) {
-          for (j = i+1; j < g->subBlocksEndIndexes[actorId][3]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  return SUCCESS;
+}
 
-    case 4 : //subBlock 4 with subBlock 4
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][4]; i < g->subBlocksEndIndexes[actorId][4] - 1; i++) {
-          for (j = i+1; j < g->subBlocksEndIndexes[actorId][4]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+void deleteCoocSchedule(COOCSCHEDULE* schedule)
+{
+  free(schedule->tileSubBlocks1);
+  schedule->tileSubBlocks1 = NULL;
 
-    case 5 :  //subBlock 0 with subBlock 1
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][0]; i < g->subBlocksEndIndexes[actorId][0]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][1]; j < g->subBlocksEndIndexes[actorId][1]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  free(schedule->tileSubBlocks2);
+  schedule->tileSubBlocks2 = NULL;
 
-    case 6 :  //subBlock 0 with subBlock 2
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][0]; i < g->subBlocksEndIndexes[actorId][0]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][2]; j < g->subBlocksEndIndexes[actorId][2]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  free(schedule->tileCosts);
+  schedule->tileCosts = NULL;
+
+  free(schedule->tileOrder);
+  schedule->tileOrder = NULL;
+
+  free(schedule->heavyActors);
+  schedule->heavyActors = NULL;
+
+  free(schedule->isHeavyActor);
+  schedule->isHeavyActor = NULL;
+
+  free(schedule->heavyBandsStart);
+  schedule->heavyBandsStart = NULL;
+
+  schedule->nHeavyActors = 0;
+  schedule->nHeavyBands = 0;
+}
+
+bool initHeavyActorsSchedule(COOCSCHEDULE* schedule)
+{
+  // An actor of degree d adds d(d-1)/2 pairs: it is heavy if those are more
+  //  than 1 / (COOC_HEAVY_ACTOR_SHARE * #threads) of the pairs of all actors
+  ulint nPairs = 0;
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    ulint degree = graphInfo.actorDegrees[actorIt];
+    nPairs += degree * (degree - 1) / 2;
+  }
+
+  arrayCalloc(schedule->isHeavyActor, graphInfo.nActors);
+  if ( schedule->isHeavyActor == NULL ) { MEM_ERROR; }
+  schedule->nHeavyActors = 0;
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    ulint degree = graphInfo.actorDegrees[actorIt];
+    if ( degree * (degree - 1) / 2 * COOC_HEAVY_ACTOR_SHARE * schedule->nThreads
+         > nPairs ) {
+      schedule->isHeavyActor[actorIt] = TRUE;
+      schedule->nHeavyActors++;
+    }
+  }
+  if ( schedule->nHeavyActors == 0 ) { return SUCCESS; }
+
+  arrayCalloc(schedule->heavyActors, schedule->nHeavyActors);
+  if ( schedule->heavyActors == NULL ) { MEM_ERROR; }
+  uint heavyIt = 0;
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    if ( schedule->isHeavyActor[actorIt] ) {
+      schedule->heavyActors[heavyIt++] = actorIt;
+    }
+  }
+
+  // Bands of (about) equal expected cost
+  // Lists are sorted, so row e gets a pair for every later event of the list:
+  //  its expected cost is proportional to the degree of e times the degrees
+  //  of all events after e
+  schedule->nHeavyBands = min(COOC_HEAVY_BANDS_PER_THREAD * schedule->nThreads,
+                              graphInfo.nEvents);
+  arrayCalloc(schedule->heavyBandsStart, schedule->nHeavyBands + 1);
+  if ( schedule->heavyBandsStart == NULL ) { MEM_ERROR; }
+
+  double* rowCosts;
+  arrayCalloc(rowCosts, graphInfo.nEvents);
+  if ( rowCosts == NULL ) { MEM_ERROR; }
+  double totalCost = 0;
+  ulint laterDegrees = graphInfo.nEdges;
+  for (uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
+    laterDegrees -= graphInfo.eventDegrees[eventIt];
+    rowCosts[eventIt] = (double) graphInfo.eventDegrees[eventIt] * laterDegrees;
+    totalCost += rowCosts[eventIt];
+  }
+  double accCost = 0;
+  uint bandIt = 1;
+  for (uint eventIt = 0; eventIt < graphInfo.nEvents
+                         && bandIt < schedule->nHeavyBands; eventIt++) {
+    accCost += rowCosts[eventIt];
+    if ( accCost >= totalCost * bandIt / schedule->nHeavyBands ) {
+      schedule->heavyBandsStart[bandIt++] = eventIt + 1;
+    }
+  }
+  for (; bandIt <= schedule->nHeavyBands; bandIt++) {
+    schedule->heavyBandsStart[bandIt] = graphInfo.nEvents;
+  }
 
-    case 7 :  //subBlock 0 with subBlock 3
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][0]; i < g->subBlocksEndIndexes[actorId][0]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][3]; j < g->subBlocksEndIndexes[actorId][3]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  free(rowCosts);
+  rowCosts = NULL;
 
-    case 8 :  //subBlock 0 with subBlock 4
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][0]; i < g->subBlocksEndIndexes[actorId][0]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][4]; j < g->subBlocksEndIndexes[actorId][4]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  return SUCCESS;
+}
 
-    case 9 :  //subBlock 1 with subBlock 2
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][1]; i < g->subBlocksEndIndexes[actorId][1]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][2]; j < g->subBlocksEndIndexes[actorId][2]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+static int cmpTileCosts(const void* a, const void* b)
+{
+  // Most expensive tiles first, ties by tile ID, so that the order does not
+  //  depend on the sorting algorithm
+  uint tileId1 = *(const uint*) a;
+  uint tileId2 = *(const uint*) b;
+  double cost1 = coocSchedule.tileCosts[tileId1];
+  double cost2 = coocSchedule.tileCosts[tileId2];
+  if ( cost1 != cost2 ) { return ( cost1 < cost2 ) ? 1 : -1; }
+  return ( tileId1 > tileId2 ) - ( tileId1 < tileId2 );
+}
 
-    case 10 :  //subBlock 1 with subBlock 3
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][1]; i < g->subBlocksEndIndexes[actorId][1]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][3]; j < g->subBlocksEndIndexes[actorId][3]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+void orderCoocTiles(COOCSCHEDULE* schedule)
+{
+  // Expected number of co-occurrence increments of each tile: the events of
+  //  a list fall into a sub-block in proportion to the degrees of its events,
+  //  whatever the randomization. Every tile still visits all actors
+  // The heavy actors are not in the tiles (see initHeavyActorsSchedule())
+  double nPairs = 0;
+  uint nTileActors = 0;
+  for (uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    if ( schedule->isHeavyActor != NULL && schedule->isHeavyActor[actorIt] ) {
+      continue;
+    }
+    double degree = graphInfo.actorDegrees[actorIt];
+    nPairs += degree * (degree - 1) / 2;
+    nTileActors++;
+  }
 
-    case 11 :  //subBlock 1 with subBlock 4
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][1]; i < g->subBlocksEndIndexes[actorId][1]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][4]; j < g->subBlocksEndIndexes[actorId][4]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  double subBlockShares[schedule->nSubBlocks];
+  uint eventIt = 0;
+  for (uint sbIt = 0; sbIt < schedule->nSubBlocks; sbIt++) {
+    ulint nSubBlockEdges = 0;
+    uint sbUpperLimit = (uint) ( ((ulint) sbIt + 1) * graphInfo.nEvents
+                                 / schedule->nSubBlocks );
+    for (; eventIt < sbUpperLimit; eventIt++) {
+      nSubBlockEdges += graphInfo.eventDegrees[eventIt];
+    }
+    subBlockShares[sbIt] = (double) nSubBlockEdges / graphInfo.nEdges;
+  }
 
-    case 12 :  //subBlock 2 with subBlock 3
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][2]; i < g->subBlocksEndIndexes[actorId][2]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][3]; j < g->subBlocksEndIndexes[actorId][3]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  for (uint tileIt = 0; tileIt < schedule->nTiles; tileIt++) {
+    double share1 = subBlockShares[ schedule->tileSubBlocks1[tileIt] ];
+    double share2 = subBlockShares[ schedule->tileSubBlocks2[tileIt] ];
+    bool isDiagonal = ( schedule->tileSubBlocks1[tileIt]
+                        == schedule->tileSubBlocks2[tileIt] );
+    schedule->tileCosts[tileIt] = nPairs * share1 * share2
+                                  * ( isDiagonal ? 1 : 2 )
+                                  + nTileActors;
+    schedule->tileOrder[tileIt] = tileIt;
+  }
+  qsort(schedule->tileOrder, schedule->nTiles, sizeof(uint), cmpTileCosts);
+}
 
-    case 13 :  //subBlock 2 with subBlock 4
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][2]; i < g->subBlocksEndIndexes[actorId][2]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][4]; j < g->subBlocksEndIndexes[actorId][4]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+void computeCoocTile(GRAPH* g, uint** cooc, uint tileId)
+{
+  int i, j;
 
-    case 14 :  //subBlock 3 with subBlock 4
-      for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
-        for (i = g->subBlocksStartIndexes[actorId][3]; i < g->subBlocksEndIndexes[actorId][3]; i++) {
-          for (j = g->subBlocksStartIndexes[actorId][4]; j < g->subBlocksEndIndexes[actorId][4]; j++ ) {
-            #if PRINT_THREADS_COMPUTING_COOCCURRENCE
-            fprintf(threadCoocFile, "Thread %d! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
-                            threadId, actorId,
-                            g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
-                            i, j);
-            #endif
-            cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
-          }
-        }
-      }
-      break;
+  #if PRINT_THREADS_COMPUTING_COOCCURRENCE
+  char threadCoocFileName[40];
+  char threadIdStr[MAX_INT_STR_SIZE];
+  strcpy(threadCoocFileName, "thread");
+  sprintf(threadIdStr, "%d", omp_get_thread_num());
+  strcat(threadCoocFileName, threadIdStr);
+  strcat(threadCoocFileName, "CoocFile.dbg");
+  FILE* threadCoocFile = fopen(threadCoocFileName, "a");
+  fprintf(threadCoocFile, "BEGIN GRAPH\n");
+  #endif
 
-  } // End switch
+  // A region of the half matrix which no other tile writes to
+  uint sb1 = coocSchedule.tileSubBlocks1[tileId];
+  uint sb2 = coocSchedule.tileSubBlocks2[tileId];
+
+  for (uint actorId=0; actorId < graphInfo.nActors; actorId++) {
+    // Heavy actors: see computeCoocHeavyBand()
+    if ( coocSchedule.isHeavyActor[actorId] ) { continue; }
+    for (i = g->subBlocksStartIndexes[actorId][sb1]; i < g->subBlocksEndIndexes[actorId][sb1]; i++) {
+      // Within the same sub-block, only pairs after i (half matrix)
+      int jStart = ( sb1 == sb2 ) ? i+1 : g->subBlocksStartIndexes[actorId][sb2];
+      for (j = jStart; j < g->subBlocksEndIndexes[actorId][sb2]; j++ ) {
+        #if PRINT_THREADS_COMPUTING_COOCCURRENCE
+        fprintf(threadCoocFile, "Thread %d! Tile %u (%u, %u)! Actor %d: Indexes: ( %d %d ) Edges Ids: ( %d %d )\n",
+                        omp_get_thread_num(), tileId, sb1, sb2, actorId,
+                        g->actorAdjLists[i], g->actorAdjLists[j]-g->actorAdjLists[i]-1,
+                        i, j);
+        #endif
+        cooc[g->actorAdjLists[i]][g->actorAdjLists[j]-g->actorAdjLists[i]-1]++;
+      }
+    }
+  }
 
   #if PRINT_THREADS_COMPUTING_COOCCURRENCE
   fprintf(threadCoocFile, "END GRAPH\n\n");
@@ -1145,6 +2019,29 @@ void computeCooc(GRAPH* g, uint** cooc, int threadId)
 
 }
 
+void computeCoocHeavyBand(GRAPH* g, uint** cooc, uint bandId)
+{
+  // Pairs of the heavy actors whose first (lower) event is within the band
+  // No other band writes to these rows, and the tiles are done by now
+  uint firstEventId = coocSchedule.heavyBandsStart[bandId];
+  uint endEventId = coocSchedule.heavyBandsStart[bandId+1];
+  for (uint heavyIt = 0; heavyIt < coocSchedule.nHeavyActors; heavyIt++) {
+    uint actorId = coocSchedule.heavyActors[heavyIt];
+    uint actorListEnd = g->actorAccumulatedDegrees[actorId+1];
+    // Sorted lists (see setIndexesOfSubBlocks())
+    for (uint i = lowerBoundInList(g->actorAdjLists,
+                                   g->actorAccumulatedDegrees[actorId],
+                                   actorListEnd, firstEventId);
+         i < actorListEnd && g->actorAdjLists[i] < endEventId; i++) {
+      uint eventId = g->actorAdjLists[i];
+      uint* coocRow = cooc[eventId];
+      for (uint j = i+1; j < actorListEnd; j++) {
+        coocRow[ g->actorAdjLists[j] - eventId - 1 ]++;
+      }
+    }
+  }
+}
+
 void computeDirectEdgeCooc(GRAPH* g, uint actorId, uint** cooc)
 {
   uint actorListStart = g->actorAccumulatedDegrees[actorId];
@@ -1159,6 +2056,72 @@ void computeDirectEdgeCooc(GRAPH* g, uint actorId, uint** cooc)
   }
 }
 
+void setEventAccumulatedDegrees(GRAPH* g)
+{
+  // Event degrees do not change during randomization,
+  //  so this is needed only once per graph
+  for (uint eventIt = 0; eventIt <= graphInfo.nEvents; eventIt++) {
+    g->eventAccumulatedDegrees[eventIt] = 0;
+  }
+  for (uint edgeIt = 0; edgeIt < graphInfo.nEdges; edgeIt++) {
+    g->eventAccumulatedDegrees[ g->actorAdjLists[edgeIt] + 1 ]++;
+  }
+  for (uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
+    g->eventAccumulatedDegrees[eventIt+1] += g->eventAccumulatedDegrees[eventIt];
+  }
+}
+
+void transposeActorAdjList(GRAPH* g, uint actorId)
+{
+  // Append the edges of the given actor to the lists of its events
+  // Safe to be called concurrently for different actors,
+  //  as long as eventListsFill was reset to the start of each event list
+  for (uint edgeIt = g->actorAccumulatedDegrees[actorId];
+       edgeIt < g->actorAccumulatedDegrees[actorId+1]; edgeIt++) {
+    uint eventId = g->actorAdjLists[edgeIt];
+    uint position;
+    #pragma omp atomic capture
+    position = g->eventListsFill[eventId]++;
+    g->eventAdjLists[position] = actorId;
+    g->eventEdgeIndexes[position] = edgeIt;
+  }
+}
+
+void accumulateCoocRow(GRAPH* g, uint eventId, uint* accumulator)
+{
+  // Row eventId of B.B^T (Gustavson), B being the event x actor adj. matrix:
+  //  every actor of the event contributes with the events that follow
+  //  eventId in its (sorted) list. The accumulator is a dense per-thread row,
+  //  indexed by the event ID of the column.
+  for (uint listIt = g->eventAccumulatedDegrees[eventId];
+       listIt < g->eventAccumulatedDegrees[eventId+1]; listIt++) {
+    uint actorId = g->eventAdjLists[listIt];
+    uint actorListEnd = g->actorAccumulatedDegrees[actorId+1];
+    for (uint edgeIt = g->eventEdgeIndexes[listIt] + 1;
+         edgeIt < actorListEnd; edgeIt++) {
+      accumulator[ g->actorAdjLists[edgeIt] ]++;
+    }
+    // Non-bipartite graphs: the direct edge between both nodes
+    //  (same as computeDirectEdgeCooc())
+    if ( !settings.isBipartiteGraph && actorId > eventId ) {
+      accumulator[actorId] += settings.directEdgeCoocValue;
+    }
+  }
+}
+
+void computeCoocRow(GRAPH* g, uint** cooc, uint eventId, uint* accumulator)
+{
+  // The accumulated row is written back to the half matrix at once,
+  //  and the accumulator is left cleared
+  accumulateCoocRow(g, eventId, accumulator);
+
+  uint* coocRow = cooc[eventId];
+  for (uint colEvent = eventId + 1; colEvent < graphInfo.nEvents; colEvent++) {
+    coocRow[colEvent - eventId - 1] += accumulator[colEvent];
+    accumulator[colEvent] = 0;
+  }
+}
+
 uint eventPairCoocCalc (GRAPH* g, uint event1, uint event2)
 {
   // Single pair co-occurrence calculation
@@ -1171,55 +2134,193 @@ uint eventPairCoocCalc (GRAPH* g, uint event1, uint event2)
   //  the edge between the two nodes of the pair
   //  counts as two co-occurences.
 
-  // Iterates through blocks of adjacency matrix
-  //  performing a bitwise AND operation of the current block from each event row
+  // Bitwise AND of both event rows of the adjacency matrix
+  // The number of set bits ("1's") is the co-occurence between the two nodes
   uint cooc = 0;
-  for(uint blockIt=0; blockIt < graphInfo.nBlocksPerEvent; blockIt++) {
-    // The number of set bits ("1's") is the co-occurence between the two nodes
-    cooc +=
-        popCount(   g->adjMatrix[event1 * graphInfo.nBlocksPerEvent+blockIt]
-                  & g->adjMatrix[event2 * graphInfo.nBlocksPerEvent+blockIt] );
-  }
+  andPopCountBlock(&g->adjMatrix[ (size_t)event1 * graphInfo.nBlocksPerEvent ], 1,
+                   &g->adjMatrix[ (size_t)event2 * graphInfo.nBlocksPerEvent ], 1,
+                   graphInfo.nBlocksPerEvent, &cooc);
 
   return cooc;
 }
+
+void computeCoocBitMatrixRows(GRAPH* g, uint** cooc, uint firstEventId)
+{
+  // Co-occurrence of events [firstEventId, firstEventId+COOC_BITMATRIX_ROW_TILE)
+  //  with all events of higher ID, i.e. a band of rows of the half matrix
+  // The rows are crossed with panels of COOC_BITMATRIX_COL_TILE event rows of
+  //  the adj. matrix, starting at the band itself (the part of that first
+  //  panel below the diagonal is discarded)
+  const uint nBlocksPerEvent = graphInfo.nBlocksPerEvent;
+  const uint nRows = min( (uint) COOC_BITMATRIX_ROW_TILE,
+                          graphInfo.nEvents - 1 - firstEventId );
+  const BLOCK* rows = &g->adjMatrix[ (size_t)firstEventId * nBlocksPerEvent ];
+  uint counts[COOC_BITMATRIX_ROW_TILE * COOC_BITMATRIX_COL_TILE];
+
+  for (uint firstColId = firstEventId; firstColId < graphInfo.nEvents;
+       firstColId += COOC_BITMATRIX_COL_TILE) {
+    const uint nCols = min( (uint) COOC_BITMATRIX_COL_TILE,
+                            graphInfo.nEvents - firstColId );
+    andPopCountBlock(rows, nRows,
+                     &g->adjMatrix[ (size_t)firstColId * nBlocksPerEvent ], nCols,
+                     nBlocksPerEvent, counts);
+
+    for (uint rowIt = 0; rowIt < nRows; ++rowIt) {
+      const uint eventId1 = firstEventId + rowIt;
+      for (uint colIt = 0; colIt < nCols; ++colIt) {
+        const uint eventId2 = firstColId + colIt;
+        if ( eventId2 <= eventId1 ) { continue; }
+
+        uint pairCooc = counts[ rowIt * nCols + colIt ];
+        // Non-bipartite graphs: the main diagonal of the adj. matrix makes
+        //  an edge between the two nodes count as two co-occurrences
+        if ( !settings.isBipartiteGraph
+             && checkBitOnBlockArray(g->adjMatrix, eventId2,
+                                     (size_t)eventId1 * nBlocksPerEvent) ) {
+          pairCooc = pairCooc - 2 + settings.directEdgeCoocValue;
+        }
+        cooc[eventId1][eventId2 - eventId1 - 1] += pairCooc;
+      }
+    }
+  }
+}
+
+COOCENGINE autoSelectCoocEngine()
+{
+  // The bit matrix engine needs the adj. matrix itself
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    return COOC_ENGINE_SUBBLOCKS;
+  }
+
+  // The bit matrix engine ANDs every pair of event rows, whatever the edges,
+  //  while the list kernel work is the number of pairs of edges sharing an
+  //  actor, i.e. the total co-occurrence
+  double bitMatrixCost = (double) graphInfo.nPairs * graphInfo.nBlocksPerEvent;
+  double listCost = (double) COOC_AUTO_WORDS_PER_EDGE_PAIR * graphInfo.coocSum;
+
+  if ( bitMatrixCost < listCost ) {
+    return COOC_ENGINE_BITMATRIX;
+  }
+  return COOC_ENGINE_SUBBLOCKS;
+}
 /* **************************************** */
 
 void resultList(PAIR* pairs, TMPRESULT* tmpResult,
                 uint nEvents, uint nSamples)
 {
-  uint pairIt=0;
   for (uint row=0; row<(nEvents-1); row++) {
-    for (uint col=0; col<(nEvents-1-row); col++) {
-      if ( graphInfo.originalCooc[row][col] >= settings.minRelevantCooc ) {
-        pairs[pairIt].eventId1 = row;
-        pairs[pairIt].eventId2 = row + col + 1;
-        pairs[pairIt].relevantPairId = pairIt;
-        pairs[pairIt].pValue = tmpResult->pValue[row][col];
-        pairs[pairIt].zScore = zScore_uint(graphInfo.originalCooc[row][col],
-                                           tmpResult->coocSum[row][col],
-                                           tmpResult->coocSquareSum[row][col],
-                                           nSamples);
-        pairIt++;
-      }
+    for (uint pairIt = graphInfo.relevantPairsRowStart[row];
+         pairIt < graphInfo.relevantPairsRowStart[row+1]; pairIt++) {
+      uint col = graphInfo.relevantPairsCols[pairIt];
+      pairs[pairIt].eventId1 = row;
+      pairs[pairIt].eventId2 = row + col + 1;
+      pairs[pairIt].relevantPairId = pairIt;
+      pairs[pairIt].pValue = tmpResult->pValue[pairIt];
+      pairs[pairIt].zScore = zScore_uint(graphInfo.originalCooc[row][col],
+                                         tmpResult->coocSum[pairIt],
+                                         tmpResult->coocSquareSum[pairIt],
+                                         nSamples);
     }
   }
 }
 
-bool coocHalfMatricesInitialize(TMPRESULT* tmpResult, uint nEvents)
+ulint foldCoocRowStatistics(TMPRESULT* tmpResult, uint eventId,
+                            uint* accumulator, uint graphIt)
+{
+  // Same statistics as threadUpdateTmpResult(), but taken from an accumulated
+  //  row (see accumulateCoocRow()), which is left cleared
+  // Returns the co-occurrence sum of the row, for checking purposes
+  for (uint pairIt = graphInfo.relevantPairsRowStart[eventId];
+       pairIt < graphInfo.relevantPairsRowStart[eventId+1]; pairIt++) {
+    uint col = graphInfo.relevantPairsCols[pairIt];
+    uint cooc = accumulator[eventId + col + 1];
+    if ( tmpResult->roundCooc != NULL ) {
+      // Folded with the other graphs (see foldRoundStatistics())
+      tmpResult->roundCooc[ (size_t)graphIt * graphInfo.nRelevantPairs
+                            + pairIt ] = cooc;
+      continue;
+    }
+    tmpResult->coocSum[pairIt] += cooc;
+    tmpResult->coocSquareSum[pairIt] += cooc * cooc;
+    if(graphInfo.originalCooc[eventId][col] < cooc) {
+      tmpResult->pValue[pairIt]++;
+    } else
+    if(graphInfo.originalCooc[eventId][col] == cooc){
+      tmpResult->pValue[pairIt] += (graphIt % 2);
+    }
+  }
+
+  ulint rowCoocSum = 0;
+  for (uint colEvent = eventId + 1; colEvent < graphInfo.nEvents; colEvent++) {
+    rowCoocSum += accumulator[colEvent];
+    accumulator[colEvent] = 0;
+  }
+
+  return rowCoocSum;
+}
+
+void foldRoundStatistics(TMPRESULT* tmpResult,
+                         uint firstRelevantPairId, uint nRelevantPairs)
+{
+  // Co-occurrences of the round, from every graph
+  foldStatisticsBatch(&tmpResult->roundCooc[firstRelevantPairId],
+                      graphInfo.nRelevantPairs, settings.nReplicas,
+                      &tmpResult->originalNarrowCooc[firstRelevantPairId],
+                      nRelevantPairs,
+                      &tmpResult->coocSum[firstRelevantPairId],
+                      &tmpResult->coocSquareSum[firstRelevantPairId],
+                      &tmpResult->pValue[firstRelevantPairId]);
+}
+
+bool hasNarrowRoundCooc()
+{
+  // Degrees do not change, so no co-occurrence can be greater than
+  //  the greatest event degree (plus the direct edge, if any)
+  ulint maxCooc = (ulint) graphInfo.maxEventDegree;
+  if ( !settings.isBipartiteGraph ) {
+    maxCooc += settings.directEdgeCoocValue;
+  }
+  return ( maxCooc <= NARROW_COOC_MAX );
+}
+
+bool tmpResultInitialize(TMPRESULT* tmpResult, uint nEvents)
 {
-  halfMatrixCalloc(tmpResult->pValue, nEvents-1);
+  // Statistics of the relevant pairs only
+  arrayCalloc(tmpResult->pValue, graphInfo.nRelevantPairs);
   if ( tmpResult->pValue == NULL ) { MEM_ERROR; }
 
-  halfMatrixCalloc(tmpResult->coocSum, nEvents-1);
+  arrayCalloc(tmpResult->coocSum, graphInfo.nRelevantPairs);
   if ( tmpResult->coocSum == NULL ) { MEM_ERROR; }
 
-  halfMatrixCalloc(tmpResult->coocSquareSum, nEvents-1);
+  arrayCalloc(tmpResult->coocSquareSum, graphInfo.nRelevantPairs);
   if ( tmpResult->coocSquareSum == NULL ) { MEM_ERROR; }
 
-  // TODO: could maybe be done in a clearer way
-  tmpResult->lastCooc = (uint**) calloc ((nEvents-1), sizeof(uint*));
-  if ( tmpResult->lastCooc == NULL ) { MEM_ERROR; }
+  // Written by the co-occurrence engines, and cleared after being folded
+  //  into the statistics, so it is allocated once for all samples
+  // Not needed when statistics are folded straight from the accumulated rows
+  tmpResult->lastCooc = NULL;
+  if ( !settings.fusedStats ) {
+    halfMatrixCalloc(tmpResult->lastCooc, nEvents-1);
+    if ( tmpResult->lastCooc == NULL ) { MEM_ERROR; }
+  }
+
+  tmpResult->roundCooc = NULL;
+  tmpResult->originalNarrowCooc = NULL;
+  if ( hasNarrowRoundCooc() ) {
+    arrayCalloc(tmpResult->roundCooc,
+                (size_t)settings.nReplicas * graphInfo.nRelevantPairs);
+    if ( tmpResult->roundCooc == NULL ) { MEM_ERROR; }
+
+    arrayCalloc(tmpResult->originalNarrowCooc, graphInfo.nRelevantPairs);
+    if ( tmpResult->originalNarrowCooc == NULL ) { MEM_ERROR; }
+    for (uint row=0; row<(nEvents-1); row++) {
+      for (uint pairIt = graphInfo.relevantPairsRowStart[row];
+           pairIt < graphInfo.relevantPairsRowStart[row+1]; pairIt++) {
+        tmpResult->originalNarrowCooc[pairIt] =
+            graphInfo.originalCooc[row][ graphInfo.relevantPairsCols[pairIt] ];
+      }
+    }
+  }
 
   return SUCCESS;
 }
@@ -1266,6 +2367,15 @@ ulint perturbationMeasure(GRAPH* g, GRAPH* baseG) {
           diffEdges += baseListEnd - baseListIdx;
         }
       }
+    } else if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+      // Using edge sets - edges missing from the base graph, each of which
+      //  also leaves one of the base graph edges out (same number of edges)
+      for ( uint edgeIt=0; edgeIt < graphInfo.nEdges; ++edgeIt ) {
+        if ( !edgeSetContains(&baseG->edgeSet, g->actorEdgeMaps[edgeIt],
+                              g->actorAdjLists[edgeIt]) ) {
+          diffEdges += 2;
+        }
+      }
     } else {
       // Using adj. matrix - XOR everyblock and count 1's
       for ( ulint blockIt=0; blockIt < graphInfo.nBlocksAdjMatrix; ++blockIt) {
@@ -1334,6 +2444,12 @@ bool copyGraphInfoValues(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo) {
   gInfo->coocSum = baseGInfo->coocSum;
   gInfo->nRelevantPairs = baseGInfo->nRelevantPairs;
 
+  gInfo->maxEventDegree = baseGInfo->maxEventDegree;
+  gInfo->maxActorDegree = baseGInfo->maxActorDegree;
+
+  gInfo->eventDegreesChecksum = baseGInfo->eventDegreesChecksum;
+  gInfo->actorDegreesChecksum = baseGInfo->actorDegreesChecksum;
+
   return SUCCESS;
 }
 
@@ -1349,11 +2465,8 @@ bool copyGraphInfoArrays(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo) {
 
   // Original co-oc
   if ( baseGInfo->originalCooc != NULL ) {
-    for ( uint row = 0; row < gInfo->nEvents - 1; ++row ) {
-      for ( uint col = 0; col < gInfo->nEvents - 1 - row; ++col ) {
-        gInfo->originalCooc[row][col] = baseGInfo->originalCooc[row][col];
-      }
-    }
+    memcpy(gInfo->originalCooc[0], baseGInfo->originalCooc[0],
+           halfMatrixSize(gInfo->nEvents - 1) * sizeof(uint));
   }
 
   // Events' degree sequence
@@ -1370,6 +2483,11 @@ bool copyGraphInfoArrays(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo) {
     }
   }
 
+  // Relevant pairs index - rebuilt from the copied original co-oc
+  if ( baseGInfo->relevantPairsRowStart != NULL ) {
+    if ( buildRelevantPairsIndex(gInfo) == FAILURE ) { FORWARD_ERROR; }
+  }
+
   return SUCCESS;
 }
 
@@ -1393,6 +2511,50 @@ bool copyGraphInfo(GRAPHINFO* gInfo, GRAPHINFO* baseGInfo) {
   return SUCCESS;
 }
 
+bool buildRelevantPairsIndex(GRAPHINFO* gInfo)
+{
+  // Relevant pairs are the ones whose original co-occurrence is at least
+  //  settings.minRelevantCooc. They are the only ones evaluated by the
+  //  heuristics and written to the output, so the sampling statistics are
+  //  accumulated for them only, in row-major order of the half matrix
+  free(gInfo->relevantPairsRowStart);
+  free(gInfo->relevantPairsCols);
+
+  arrayCalloc(gInfo->relevantPairsRowStart, gInfo->nEvents);
+  if ( gInfo->relevantPairsRowStart == NULL ) { MEM_ERROR; }
+
+  // Number of relevant pairs of each row, accumulated
+  uint nIndexedPairs = 0;
+  for (uint row=0; row < gInfo->nEvents-1; row++) {
+    gInfo->relevantPairsRowStart[row] = nIndexedPairs;
+    for (uint col=0; col < gInfo->nEvents-1-row; col++) {
+      nIndexedPairs +=
+          ( gInfo->originalCooc[row][col] >= settings.minRelevantCooc );
+    }
+  }
+  gInfo->relevantPairsRowStart[gInfo->nEvents-1] = nIndexedPairs;
+
+  if ( nIndexedPairs != gInfo->nRelevantPairs ) {
+    STDERR_INFO("Unexpected behavior - %u relevant pairs indexed, "
+                "but %u were expected!", nIndexedPairs, gInfo->nRelevantPairs);
+    RETURN_ERROR;
+  }
+
+  // Their columns
+  arrayCalloc(gInfo->relevantPairsCols, gInfo->nRelevantPairs);
+  if ( gInfo->relevantPairsCols == NULL ) { MEM_ERROR; }
+  uint pairIt = 0;
+  for (uint row=0; row < gInfo->nEvents-1; row++) {
+    for (uint col=0; col < gInfo->nEvents-1-row; col++) {
+      if ( gInfo->originalCooc[row][col] >= settings.minRelevantCooc ) {
+        gInfo->relevantPairsCols[pairIt++] = col;
+      }
+    }
+  }
+
+  return SUCCESS;
+}
+
 bool areEqualGraphInfos(GRAPHINFO* gInfo1, GRAPHINFO* gInfo2)
 {
   // Trivial comparison
@@ -1409,6 +2571,8 @@ bool areEqualGraphInfos(GRAPHINFO* gInfo1, GRAPHINFO* gInfo2)
 
   if ( gInfo1->coocSum != gInfo2->coocSum ) { return FALSE; }
   if ( gInfo1->nRelevantPairs != gInfo2->nRelevantPairs ) { return FALSE; }
+  if ( gInfo1->maxEventDegree != gInfo2->maxEventDegree ) { return FALSE; }
+  if ( gInfo1->maxActorDegree != gInfo2->maxActorDegree ) { return FALSE; }
 
   // Arrays
   // Event list - array of strings
@@ -1482,14 +2646,7 @@ void deleteGraphInfoArrays(GRAPHINFO* gInfo)
     gInfo->eventList = NULL;
   }
 
-  if ( gInfo->originalCooc != NULL ) {
-    for (uint eventIt = 0; eventIt < gInfo->nEvents-1; ++eventIt) {
-      free(gInfo->originalCooc[eventIt]);
-      gInfo->originalCooc[eventIt] = NULL;
-    }
-    free(gInfo->originalCooc);
-    gInfo->originalCooc = NULL;
-  }
+  halfMatrixFree(gInfo->originalCooc, gInfo->nEvents-1);
 
   free(gInfo->eventDegrees);
   gInfo->eventDegrees = NULL;
@@ -1497,6 +2654,12 @@ void deleteGraphInfoArrays(GRAPHINFO* gInfo)
   free(gInfo->actorDegrees);
   gInfo->actorDegrees = NULL;
 
+  free(gInfo->relevantPairsRowStart);
+  gInfo->relevantPairsRowStart = NULL;
+
+  free(gInfo->relevantPairsCols);
+  gInfo->relevantPairsCols = NULL;
+
 }
 
 void deleteGraphInfo(GRAPHINFO* gInfo)
@@ -1520,9 +2683,19 @@ bool allocGraph(GRAPH* g) {
   // Free graph, if existing
   deleteGraph(g);
 
-  // adjMatrix
-  arrayCalloc(g->adjMatrix, graphInfo.nBlocksAdjMatrix);
-  if ( g->adjMatrix == NULL ) { MEM_ERROR; }
+  // adjMatrix, or its edge set (see "-edgelookup")
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    if ( allocEdgeSet(&g->edgeSet, graphInfo.nEdges) == FAILURE ) {
+      FORWARD_ERROR;
+    }
+  } else {
+    arrayCalloc(g->adjMatrix, graphInfo.nBlocksAdjMatrix);
+    if ( g->adjMatrix == NULL ) { MEM_ERROR; }
+  }
+  if ( settings.globalSingleSwitch ) {
+    arrayCalloc(g->swapClaims, nSwapClaimBlocks());
+    if ( g->swapClaims == NULL ) { MEM_ERROR; }
+  }
 
   // actorAdjLists
   arrayCalloc(g->actorAdjLists, graphInfo.nEdges);
@@ -1544,20 +2717,139 @@ bool allocGraph(GRAPH* g) {
 
   // subBlocks Indexes
   fullMatrixCalloc(g->subBlocksStartIndexes,
-                   graphInfo.nActors, NUMBER_OF_SUBBLOCKS);
+                   graphInfo.nActors, coocSchedule.nSubBlocks);
   if ( g->subBlocksStartIndexes == NULL ) { MEM_ERROR; }
 
   fullMatrixCalloc(g->subBlocksEndIndexes,
-                   graphInfo.nActors, NUMBER_OF_SUBBLOCKS);
+                   graphInfo.nActors, coocSchedule.nSubBlocks);
   if ( g->subBlocksEndIndexes == NULL ) { MEM_ERROR; }
 
+  if ( needsEventAdjLists() ) {
+    if ( allocEventAdjLists(g) == FAILURE ) { FORWARD_ERROR; }
+  }
+
+  return SUCCESS;
+}
+
+size_t graphReplicaBytes()
+{
+  // Memory of each replica: its graph, which mirrors allocGraph(),
+  //  allocEventAdjLists() and threadInitIncrementalCooc() (sizes only: the
+  //  pointer is never dereferenced), its snapshot (pipelined sampling), its
+  //  co-occurrences in the round statistics (see tmpResultInitialize()), and
+  //  the scratch of its thread, outside the global modes (see
+  //  threadScratchBytes())
+  GRAPH* g = NULL;
+  size_t nBytes = 0;
+
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    nBytes += edgeSetSlots(graphInfo.nEdges) * sizeof *g->edgeSet.keys;
+  } else {
+    nBytes += graphInfo.nBlocksAdjMatrix * sizeof *g->adjMatrix;
+  }
+  if ( settings.globalSingleSwitch ) {
+    nBytes += nSwapClaimBlocks() * sizeof *g->swapClaims;
+  }
+  nBytes += (size_t)graphInfo.nEdges * sizeof *g->actorAdjLists;
+  nBytes += (size_t)(graphInfo.nActors+1) * sizeof *g->actorAccumulatedDegrees;
+  nBytes += (size_t)graphInfo.nEdges * sizeof *g->actorEdgeMaps;
+  if ( !settings.isBipartiteGraph ) {
+    nBytes += (size_t)graphInfo.nEdges * sizeof *g->edgeLinks;
+  }
+  nBytes += 2 * (size_t)graphInfo.nActors * coocSchedule.nSubBlocks
+            * sizeof **g->subBlocksStartIndexes;
+
+  if ( needsEventAdjLists() ) {
+    nBytes += (size_t)graphInfo.nEdges * sizeof *g->eventAdjLists;
+    nBytes += (size_t)graphInfo.nEdges * sizeof *g->eventEdgeIndexes;
+    nBytes += (size_t)(graphInfo.nEvents+1)
+              * sizeof *g->eventAccumulatedDegrees;
+    nBytes += (size_t)graphInfo.nEvents * sizeof *g->eventListsFill;
+  }
+
+  if ( settings.incrementalCooc ) {
+    nBytes += halfMatrixSize(graphInfo.nEvents - 1) * sizeof **g->cooc;
+  }
+
+  if ( settings.pipelinedSampling ) {
+    nBytes *= 2;
+  }
+
+  // The relevant pairs are not known yet: at most as many as the original
+  //  co-occurrence sum allows
+  if ( hasNarrowRoundCooc() ) {
+    size_t nRelevantPairs = halfMatrixSize(graphInfo.nEvents - 1);
+    if ( settings.minRelevantCooc > 0 ) {
+      nRelevantPairs = min(nRelevantPairs,
+                           (size_t)( graphInfo.coocSum
+                                     / settings.minRelevantCooc ));
+    }
+    nBytes += nRelevantPairs * sizeof(uint16_t);
+  }
+
+  if ( !settings.globalCurveball && !settings.globalSingleSwitch ) {
+    nBytes += threadScratchBytes();
+  }
+
+  return nBytes;
+}
+
+size_t threadScratchBytes()
+{
+  // Mirrors threadAllocScratch() for each thread of the rank: the pool of
+  //  its trades in its scratch arena, and its event stamps
+  size_t nBytes = 0;
+  if ( needsTradeScratch() ) {
+    nBytes += curveballArenaSize();
+    if (    settings.curveballKernel == CURVEBALL_KERNEL_STAMPED
+         || settings.curveballKernel == CURVEBALL_KERNEL_ADAPTIVE ) {
+      nBytes += (size_t)nTradeListIds() * sizeof *tradeScratch->eventStamps;
+    }
+  }
+
+  return nBytes;
+}
+
+bool allocEventAdjLists(GRAPH* g)
+{
+  arrayCalloc(g->eventAdjLists, graphInfo.nEdges);
+  if ( g->eventAdjLists == NULL ) { MEM_ERROR; }
+
+  arrayCalloc(g->eventEdgeIndexes, graphInfo.nEdges);
+  if ( g->eventEdgeIndexes == NULL ) { MEM_ERROR; }
+
+  arrayCalloc(g->eventAccumulatedDegrees, graphInfo.nEvents+1);
+  if ( g->eventAccumulatedDegrees == NULL ) { MEM_ERROR; }
+
+  arrayCalloc(g->eventListsFill, graphInfo.nEvents);
+  if ( g->eventListsFill == NULL ) { MEM_ERROR; }
+
   return SUCCESS;
 }
 
+bool needsTradeScratch()
+{
+  // Every curveball kernel takes its pool from the scratch arena
+  return settings.runCurveball;
+}
+
+bool needsEventAdjLists()
+{
+  return ( settings.coocEngine == COOC_ENGINE_SPGEMM || settings.fusedStats
+           || isEventSideCurveball() );
+}
+
 bool copyGraphData(GRAPH* g, GRAPH* baseG) {
 
-  for (ulint blockIt = 0; blockIt < graphInfo.nBlocksAdjMatrix; blockIt++) {
-    g->adjMatrix[blockIt] = baseG->adjMatrix[blockIt];
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    // Both sets are sized by the number of edges, so are their slots
+    memcpy(g->edgeSet.keys, baseG->edgeSet.keys,
+           (baseG->edgeSet.slotMask + 1) * sizeof *baseG->edgeSet.keys);
+    g->edgeSet.nKeys = baseG->edgeSet.nKeys;
+  } else {
+    for (ulint blockIt = 0; blockIt < graphInfo.nBlocksAdjMatrix; blockIt++) {
+      g->adjMatrix[blockIt] = baseG->adjMatrix[blockIt];
+    }
   }
 
   for (uint edgeIt = 0; edgeIt < graphInfo.nEdges; edgeIt++) {
@@ -1575,9 +2867,12 @@ bool copyGraphData(GRAPH* g, GRAPH* baseG) {
     g->actorAccumulatedDegrees[actorIt] =
         baseG->actorAccumulatedDegrees[actorIt];
   }
+  g->sortedActorAdjLists = baseG->sortedActorAdjLists;
+  g->eventDegreesChecksum = baseG->eventDegreesChecksum;
+  g->actorDegreesChecksum = baseG->actorDegreesChecksum;
 
   for (uint actorIt=0; actorIt < graphInfo.nActors; ++actorIt) {
-    for (uint sbIt=0; sbIt < NUMBER_OF_SUBBLOCKS; ++sbIt) {
+    for (uint sbIt=0; sbIt < coocSchedule.nSubBlocks; ++sbIt) {
       g->subBlocksStartIndexes[actorIt][sbIt] =
         baseG->subBlocksStartIndexes[actorIt][sbIt];
 
@@ -1586,6 +2881,21 @@ bool copyGraphData(GRAPH* g, GRAPH* baseG) {
     }
   }
 
+  // Co-occurrence kept by the trades, if both graphs keep it
+  if ( g->cooc != NULL && baseG->cooc != NULL ) {
+    memcpy(g->cooc[0], baseG->cooc[0],
+           halfMatrixSize(graphInfo.nEvents - 1) * sizeof(uint));
+  }
+
+  // Event lists are rebuilt before use, but their (constant) layout is kept
+  if ( g->eventAccumulatedDegrees != NULL
+       && baseG->eventAccumulatedDegrees != NULL ) {
+    for (uint eventIt = 0; eventIt < (graphInfo.nEvents + 1); eventIt++) {
+      g->eventAccumulatedDegrees[eventIt] =
+          baseG->eventAccumulatedDegrees[eventIt];
+    }
+  }
+
   return SUCCESS;
 }
 
@@ -1617,6 +2927,7 @@ bool canonizeGraph(GRAPH* g)
   for (uint actorIt = 0; actorIt < graphInfo.nActors; ++actorIt ) {
     setIndexesOfSubBlocks(g, actorIt);
   }
+  g->sortedActorAdjLists = TRUE;
 
   // Update redundant edge links -- non-bipartite graph only
   if ( !settings.isBipartiteGraph ) {
@@ -1713,7 +3024,7 @@ bool areEqualGraphs(GRAPH* g1, GRAPH* g2)
     }
     // If neither is NULL, both must have the same size
     for (uint actorIt=0; actorIt < graphInfo.nActors; ++actorIt) {
-      for (uint sbIt=0; sbIt < NUMBER_OF_SUBBLOCKS; ++sbIt) {
+      for (uint sbIt=0; sbIt < coocSchedule.nSubBlocks; ++sbIt) {
         if ( g1->subBlocksStartIndexes[actorIt][sbIt]
              != g2->subBlocksStartIndexes[actorIt][sbIt] ) {
           printf("SB21\n\n\n");
@@ -1731,7 +3042,7 @@ bool areEqualGraphs(GRAPH* g1, GRAPH* g2)
     }
     // If neither is NULL, both must have the same size
     for (uint actorIt=0; actorIt < graphInfo.nActors; ++actorIt) {
-      for (uint sbIt=0; sbIt < NUMBER_OF_SUBBLOCKS; ++sbIt) {
+      for (uint sbIt=0; sbIt < coocSchedule.nSubBlocks; ++sbIt) {
         if ( g1->subBlocksEndIndexes[actorIt][sbIt]
              != g2->subBlocksEndIndexes[actorIt][sbIt] ) {
           printf("SB22\n\n\n");
@@ -1751,6 +3062,10 @@ void deleteGraph(GRAPH* g)
 
   free(g->adjMatrix);
   g->adjMatrix = NULL;
+  deleteEdgeSet(&g->edgeSet);
+
+  free(g->swapClaims);
+  g->swapClaims = NULL;
 
   free(g->actorAdjLists);
   g->actorAdjLists = NULL;
@@ -1779,15 +3094,111 @@ void deleteGraph(GRAPH* g)
   free(g->subBlocksEndIndexes);
   g->subBlocksEndIndexes = NULL;
 
+  free(g->eventAdjLists);
+  g->eventAdjLists = NULL;
+
+  free(g->eventEdgeIndexes);
+  g->eventEdgeIndexes = NULL;
+
+  free(g->eventAccumulatedDegrees);
+  g->eventAccumulatedDegrees = NULL;
+
+  free(g->eventListsFill);
+  g->eventListsFill = NULL;
+
+  halfMatrixFree(g->cooc, graphInfo.nEvents - 1);
+
+}
+
+size_t curveballArenaSize()
+{
+  // Largest scratch of one trade of any kernel, which is that of the two
+  //  actors of largest degree
+  size_t maxLength = maxTradeListLength();
+  // Hashed kernel: one hash item per list entry, and the vectorized pool
+  size_t hashedSize = arenaArraySize(POOL_HASH, 2 * maxLength)
+                      + arenaArraySize(uint, 2 * maxLength)
+                      + 2 * arenaArraySize(uint, maxLength);
+  // and the table of the hash, with every bucket array it grows through (the
+  //  replaced ones are only given back with the arena) up to one bucket per
+  //  two items. Larger tables fall back to the allocator
+  hashedSize += arenaArraySize(UT_hash_table, 1);
+  for (size_t nBuckets = HASH_INITIAL_NUM_BUCKETS; ; nBuckets *= 2) {
+    hashedSize += arenaArraySize(UT_hash_bucket, nBuckets);
+    if ( nBuckets >= maxLength ) { break; }
+  }
+  // Sorted kernel: pool, in-pool indexes, common events, intersection
+  //  bitmaps, drawn pool positions, and the moves of incremental trades
+  size_t sortedSize = 2 * arenaArraySize(uint, 2 * maxLength)
+                      + 3 * arenaArraySize(uint, maxLength)
+                      + 2 * arenaArraySize(uint8_t, (maxLength + 7) / 8)
+                      + arenaArraySize(bool, 2 * maxLength)
+                      + 4 * arenaArraySize(uint, maxLength);
+  // The stamped kernel needs the pool and in-pool indexes only, which are
+  //  included in both
+  size_t arenaSize = max(hashedSize, sortedSize);
+  if ( isEventSideCurveball() ) {
+    // Fill of each actor list (see actorAdjListsFromEventAdjLists())
+    arenaSize = max(arenaSize, arenaArraySize(uint, graphInfo.nActors));
+  }
+  return arenaSize;
+}
+
+bool allocTradeScratch(TRADESCRATCH* scratch, SCRATCHARENA* arena)
+{
+  // Free scratch, if existing
+  deleteTradeScratch(scratch);
+
+  if ( arenaReserve(arena, curveballArenaSize()) == FAILURE ) {
+    FORWARD_ERROR;
+  }
+  scratch->arena = arena;
+
+  // Event stamps of the stamped and adaptive kernels
+  if (    settings.curveballKernel == CURVEBALL_KERNEL_STAMPED
+       || settings.curveballKernel == CURVEBALL_KERNEL_ADAPTIVE ) {
+    arrayCalloc(scratch->eventStamps, nTradeListIds());
+    if ( scratch->eventStamps == NULL ) { MEM_ERROR; }
+  }
+  scratch->stampEpoch = 0;
+  scratch->checksumDelta = 0;
+
+  return SUCCESS;
+}
+
+void deleteTradeScratch(TRADESCRATCH* scratch)
+{
+  // The arena is not owned by the scratch (see scratchArena)
+  free(scratch->eventStamps);
+  scratch->eventStamps = NULL;
+
+  scratch->arena = NULL;
 }
 
 bool adjMatrixFromAdjLists(GRAPH* g)
 {
+  // Or its edge set, without the matrix (see "-edgelookup")
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    return edgeSetFromAdjLists(g);
+  }
+
   // Clear the adj. matrix
   for(uint blockIt = 0; blockIt < graphInfo.nBlocksAdjMatrix; ++blockIt) {
     g->adjMatrix[blockIt] = 0;
   }
 
+  // Event lists current, after event-side trades (bipartite graphs only)
+  if ( g->staleActorAdjLists ) {
+    for(uint eventIt = 0; eventIt < graphInfo.nEvents; ++eventIt) {
+      for(uint listIt = g->eventAccumulatedDegrees[eventIt];
+          listIt < g->eventAccumulatedDegrees[eventIt + 1]; ++listIt) {
+        setBitOnBlockArray(g->adjMatrix, g->eventAdjLists[ listIt ],
+                           eventIt * graphInfo.nBlocksPerEvent);
+      }
+    }
+    return SUCCESS;
+  }
+
   // For each actor, set bits in the matrix representing its edges
   // And for non-bipartite graphs, set the main diagonal (self-loops)
   for(uint actorIt = 0; actorIt < graphInfo.nActors; ++actorIt) {
@@ -1839,6 +3250,12 @@ bool adjListsFromAdjMatrix(GRAPH* g)
 
 uint getNodeDegreeViaAdjMatrix(GRAPH* g, uint nodeId, const char* nodeType)
 {
+  // Without the matrix, its edge set is checked against the lists as a whole
+  //  (see checkAdjStructs()), so the degree is the one of the lists
+  if ( g->adjMatrix == NULL ) {
+    return getNodeDegreeViaAdjLists(g, nodeId, nodeType);
+  }
+
   uint nodeDegree = 0;
   if ( !strcmp("event", nodeType) ) { // If getting event degree
     for (uint blockIt = 0;
@@ -1925,6 +3342,7 @@ uint findLinkedEgde(GRAPH* g, uint edgeKnown) {
 /* Debug print-outs/checking related functions */
 void printAdjMatrix(GRAPH* g, const char* adjMatrixFileName)
 {
+  if ( g->adjMatrix == NULL ) { return; } // Edge set instead
   FILE* adjMatrixFile = fopen(adjMatrixFileName, "a");
   fprintf(adjMatrixFile,"\nAdjacency matrix\n      \\ Actors\nEvents\n\t");
   for (uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
@@ -2008,19 +3426,51 @@ void printEventList()
 
 bool initOriginalNodeDegrees(GRAPH* g)
 {
+  graphInfo.maxActorDegree = 0;
   for(uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
     // Getting original actor degrees from lists, which is more trivial
     graphInfo.actorDegrees[actorIt] =
         getNodeDegreeViaAdjLists(g, actorIt, "actor");
     if ( graphInfo.actorDegrees[actorIt] == 0 ) { FORWARD_ERROR; }
+    graphInfo.maxActorDegree = max(graphInfo.maxActorDegree,
+                                   graphInfo.actorDegrees[actorIt]);
+  }
+
+  if ( g->adjMatrix == NULL ) {
+    // Without the matrix, the event degrees are counted in a single pass
+    //  over the lists (see "-edgelookup")
+    memset(graphInfo.eventDegrees, 0,
+           graphInfo.nEvents * sizeof *graphInfo.eventDegrees);
+    for(uint edgeIt = 0; edgeIt < graphInfo.nEdges; edgeIt++) {
+      graphInfo.eventDegrees[ g->actorAdjLists[edgeIt] ]++;
+    }
   }
 
+  graphInfo.maxEventDegree = 0;
   for(uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
     // Getting original event degrees from matrix, which is more trivial
-    graphInfo.eventDegrees[eventIt] =
-        getNodeDegreeViaAdjMatrix(g, eventIt, "event");
+    if ( g->adjMatrix != NULL ) {
+      graphInfo.eventDegrees[eventIt] =
+          getNodeDegreeViaAdjMatrix(g, eventIt, "event");
+    }
     if ( graphInfo.eventDegrees[eventIt] == 0 ) { FORWARD_ERROR; }
+    graphInfo.maxEventDegree = max(graphInfo.maxEventDegree,
+                                   graphInfo.eventDegrees[eventIt]);
+  }
+
+  // Degree sequence checksums, which the copies of the graph start from
+  graphInfo.actorDegreesChecksum = 0;
+  for(uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) {
+    graphInfo.actorDegreesChecksum +=
+        graphInfo.actorDegrees[actorIt] * degreeChecksumTerm(actorIt);
+  }
+  graphInfo.eventDegreesChecksum = 0;
+  for(uint eventIt = 0; eventIt < graphInfo.nEvents; eventIt++) {
+    graphInfo.eventDegreesChecksum +=
+        graphInfo.eventDegrees[eventIt] * degreeChecksumTerm(eventIt);
   }
+  g->actorDegreesChecksum = graphInfo.actorDegreesChecksum;
+  g->eventDegreesChecksum = graphInfo.eventDegreesChecksum;
 
   return SUCCESS;
 }
@@ -2149,6 +3599,32 @@ bool checkAdjListSort(GRAPH* g)
 
 bool checkAdjStructs(GRAPH* g)
 {
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH ) {
+    // Every edge of the lists in the edge set, and nothing else
+    for(uint actorIt = 0; actorIt < graphInfo.nActors; ++actorIt) {
+      uint edgeItFirst = g->actorAccumulatedDegrees[actorIt];
+      uint edgeItLast = g->actorAccumulatedDegrees[actorIt + 1];
+      for(uint edgeIt = edgeItFirst; edgeIt < edgeItLast; ++edgeIt) {
+        uint eventId = g->actorAdjLists[ edgeIt ];
+        if ( !edgeSetContains(&g->edgeSet, actorIt, eventId) ) {
+          STDERR_INFO("Unexpected behavior - in actor's %u degree:\n"
+                      "Edge set does not contain event id %u, "
+                      "but adj list does.\n"
+                      "Impossible to know which one is right, if any.",
+                      actorIt, eventId);
+          RETURN_ERROR;
+        }
+      }
+    }
+    if ( g->edgeSet.nKeys != graphInfo.nEdges ) {
+      STDERR_INFO("Unexpected behavior - edge set holds %zu edges, "
+                  "while adj. lists hold %u!",
+                  g->edgeSet.nKeys, graphInfo.nEdges);
+      RETURN_ERROR;
+    }
+    return SUCCESS;
+  }
+
   // ASSUMING NODE DEGREES OF BOTH ADJ. MATRIX AND LISTS MATCHES WITH ORIGINAL
   // Check if edges in adj. lists are in adj. matrix
   // For each actor, check if adj list matches with adj matrix
@@ -2198,6 +3674,31 @@ bool checkEdgeLinks(GRAPH* g)
   return SUCCESS;
 }
 
+bool checkGraphInvariants(GRAPH* g)
+{
+  // Constant time check of the graph after every swap step: its degree
+  //  sequence checksums, kept by the trades from the entries they rewrite
+  //  (see curveballTrade()), are those of the original graph. The sorted
+  //  kernels merge their lists anew, and the single switches exchange list
+  //  entries, which keeps both; these are left to the full graph test
+  #if TEST_GRAPH_INVARIANTS
+  if ( g->eventDegreesChecksum != graphInfo.eventDegreesChecksum ) {
+    STDERR_INFO("Unexpected behavior - the trades changed the event degree "
+                "sequence (checksum %016lx, original %016lx)!",
+                g->eventDegreesChecksum, graphInfo.eventDegreesChecksum);
+    RETURN_ERROR;
+  }
+  if ( g->actorDegreesChecksum != graphInfo.actorDegreesChecksum ) {
+    STDERR_INFO("Unexpected behavior - the trades changed the actor degree "
+                "sequence (checksum %016lx, original %016lx)!",
+                g->actorDegreesChecksum, graphInfo.actorDegreesChecksum);
+    RETURN_ERROR;
+  }
+  #endif
+
+  return SUCCESS;
+}
+
 bool graphTest (GRAPH* g)
 {
   // Check node degrees
@@ -2205,9 +3706,9 @@ bool graphTest (GRAPH* g)
 
   if ( checkAdjListUniqueEvent(g) == FAILURE ) { FORWARD_ERROR; }
 
-  // Check is all lists are sorted in ascending order
-  if ( settings.runCurveball ) {
-//    if ( checkAdjListSort(g) == FAILURE ) { FORWARD_ERROR; }
+  // Check is all lists are sorted in ascending order, if they should be
+  if ( g->sortedActorAdjLists ) {
+    if ( checkAdjListSort(g) == FAILURE ) { FORWARD_ERROR; }
   }
 
   // Check data consistency between adj lists and matrix
@@ -2220,3 +3721,19 @@ bool graphTest (GRAPH* g)
 
   return SUCCESS;
 }
+
+bool isFullGraphTestStep(GRAPH* g)
+{
+  // Whether graphTestStep() runs the full graph test after this swap step:
+  //  on the first step, and then every settings.graphTestInterval steps
+  return ( g->nSwapSteps % settings.graphTestInterval == 0 );
+}
+
+bool graphTestStep(GRAPH* g)
+{
+  // Test of the graph after a swap step (see isFullGraphTestStep())
+  bool isFullTest = isFullGraphTestStep(g);
+  g->nSwapSteps++;
+  if ( isFullTest && graphTest(g) == FAILURE ) { FORWARD_ERROR; }
+  return checkGraphInvariants(g);
+}
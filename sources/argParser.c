@@ -53,6 +53,7 @@ int argParser(int argc, char **argv)
 
   settings.gotExternalSeed              = FALSE;
   settings.seed                         = 0;
+  settings.rngType                      = DEFAULT_RNGTYPE;
 
   settings.isBipartiteGraph             = DEFAULT_ISBIPARTITEGRAPH;
   settings.bipartiteSideOfInterest      = DEFAULT_BIPARTITESIDEOFINTEREST;
@@ -67,6 +68,21 @@ int argParser(int argc, char **argv)
   settings.thresholdTheta               = DEFAULT_THRESHOLDTHETA;
 
   settings.minRelevantCooc              = DEFAULT_MINRELEVANTCOOC;
+  settings.coocEngine                   = DEFAULT_COOCENGINE;
+  settings.curveballKernel              = DEFAULT_CURVEBALLKERNEL;
+  settings.globalCurveball              = DEFAULT_GLOBALCURVEBALL;
+  settings.globalSingleSwitch           = DEFAULT_GLOBALSINGLESWITCH;
+  settings.nReplicas                    = DEFAULT_NREPLICAS;
+  settings.nThreadsPerReplica           = DEFAULT_NTHREADSPERREPLICA;
+  settings.curveballSide                = DEFAULT_CURVEBALLSIDE;
+  settings.edgeLookup                   = DEFAULT_EDGELOOKUP;
+  settings.incrementalCooc              = DEFAULT_INCREMENTALCOOC;
+  settings.fusedStats                   = DEFAULT_FUSEDSTATS;
+  settings.persistentRound              = DEFAULT_PERSISTENTROUND;
+  settings.pipelinedSampling            = DEFAULT_PIPELINEDSAMPLING;
+  settings.nPipelineCoocThreads         = DEFAULT_NPIPELINECOOCTHREADS;
+  settings.numaPlacement                = DEFAULT_NUMAPLACEMENT;
+  settings.graphTestInterval            = DEFAULT_GRAPHTESTINTERVAL;
 
   settings.nSamples                     = DEFAULT_NSAMPLES;
   settings.nMaxSamples                  = DEFAULT_NMAXSAMPLES;
@@ -262,6 +278,28 @@ int argParser(int argc, char **argv)
       argvIdx++;
     }
 
+    else if ( !strcmp(argv[argvIdx],"-rng") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if ( !strcmp(argv[argvIdx],"mt19937") ) {
+          settings.rngType = RNG_MT19937;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"xoshiro256pp") ) {
+          settings.rngType = RNG_XOSHIRO256PP;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"philox") ) {
+          settings.rngType = RNG_PHILOX4X32;
+          isValidArg = TRUE;
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"mt19937\", \"xoshiro256pp\" or \"philox\" must "
+                    "be used after \"-rng\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
     else if ( !strcmp(argv[argvIdx],"-swaps") ) {
       argvIdx++;
       if (argvIdx < argc) {
@@ -360,6 +398,206 @@ int argParser(int argc, char **argv)
       argvIdx++;
     }
 
+    else if ( !strcmp(argv[argvIdx],"-coocengine") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if ( !strcmp(argv[argvIdx],"subblocks") ) {
+          settings.coocEngine = COOC_ENGINE_SUBBLOCKS;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"spgemm") ) {
+          settings.coocEngine = COOC_ENGINE_SPGEMM;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"bitmatrix") ) {
+          settings.coocEngine = COOC_ENGINE_BITMATRIX;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"auto") ) {
+          settings.coocEngine = COOC_ENGINE_AUTO;
+          isValidArg = TRUE;
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"subblocks\", \"spgemm\", \"bitmatrix\" or "
+                    "\"auto\" must be used after \"-coocengine\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-curveballkernel") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if ( !strcmp(argv[argvIdx],"hashed") ) {
+          settings.curveballKernel = CURVEBALL_KERNEL_HASHED;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"sorted") ) {
+          settings.curveballKernel = CURVEBALL_KERNEL_SORTED;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"stamped") ) {
+          settings.curveballKernel = CURVEBALL_KERNEL_STAMPED;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"adaptive") ) {
+          settings.curveballKernel = CURVEBALL_KERNEL_ADAPTIVE;
+          isValidArg = TRUE;
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"hashed\", \"sorted\", \"stamped\" or "
+                    "\"adaptive\" must be used after \"-curveballkernel\" "
+                    "option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-curveballside") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if ( !strcmp(argv[argvIdx],"actors") ) {
+          settings.curveballSide = CURVEBALL_SIDE_ACTORS;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"events") ) {
+          settings.curveballSide = CURVEBALL_SIDE_EVENTS;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"auto") ) {
+          settings.curveballSide = CURVEBALL_SIDE_AUTO;
+          isValidArg = TRUE;
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"actors\", \"events\" or \"auto\" must be used "
+                    "after \"-curveballside\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-edgelookup") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if ( !strcmp(argv[argvIdx],"matrix") ) {
+          settings.edgeLookup = EDGE_LOOKUP_MATRIX;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"hash") ) {
+          settings.edgeLookup = EDGE_LOOKUP_HASH;
+          isValidArg = TRUE;
+        } else if ( !strcmp(argv[argvIdx],"auto") ) {
+          settings.edgeLookup = EDGE_LOOKUP_AUTO;
+          isValidArg = TRUE;
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"matrix\", \"hash\" or \"auto\" must be used "
+                    "after \"-edgelookup\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-globalcurveball") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.globalCurveball = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.globalCurveball = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-globalcurveball\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-globalsingleswitch") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.globalSingleSwitch = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.globalSingleSwitch = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-globalsingleswitch\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-incrementalcooc") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.incrementalCooc = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.incrementalCooc = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-incrementalcooc\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-fusedstats") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.fusedStats = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.fusedStats = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-fusedstats\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-persistentround") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.persistentRound = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.persistentRound = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-persistentround\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
     else if ( !strcmp(argv[argvIdx],"-samples") ) {
       argvIdx++;
       if (argvIdx < argc) {
@@ -401,6 +639,135 @@ int argParser(int argc, char **argv)
       argvIdx++;
     }
 
+    else if ( !strcmp(argv[argvIdx],"-graphtestinterval") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          settings.graphTestInterval = strtoul(argv[argvIdx], NULL, 10);
+          if ( settings.graphTestInterval > 0 ) {
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("No positive number specified after "
+                    "\"-graphtestinterval\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-replicas") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"auto") ) {
+            settings.nReplicas = 0; // Chosen once the graph is read
+            isValidArg = TRUE;
+          } else {
+            settings.nReplicas = strtoul(argv[argvIdx], NULL, 10);
+            if ( settings.nReplicas > 0 ) {
+              isValidArg = TRUE;
+            }
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"auto\" or a positive number must be used "
+                    "after \"-replicas\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-threadsperreplica") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"auto") ) {
+            settings.nThreadsPerReplica = 0; // Chosen once the graph is read
+            isValidArg = TRUE;
+          } else {
+            settings.nThreadsPerReplica = strtoul(argv[argvIdx], NULL, 10);
+            if ( settings.nThreadsPerReplica > 0 ) {
+              isValidArg = TRUE;
+            }
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"auto\" or a positive number must be used "
+                    "after \"-threadsperreplica\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-pipeline") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.pipelinedSampling = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.pipelinedSampling = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-pipeline\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-pipelinecoocthreads") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"auto") ) {
+            settings.nPipelineCoocThreads = 0; // Chosen once the graph is read
+            isValidArg = TRUE;
+          } else {
+            settings.nPipelineCoocThreads = strtoul(argv[argvIdx], NULL, 10);
+            if ( settings.nPipelineCoocThreads > 0 ) {
+              isValidArg = TRUE;
+            }
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"auto\" or a positive number must be used "
+                    "after \"-pipelinecoocthreads\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
+    else if ( !strcmp(argv[argvIdx],"-numa") ) {
+      argvIdx++;
+      if (argvIdx < argc) {
+        if (argv[argvIdx][0] != '-' ) {
+          if ( !strcmp(argv[argvIdx],"false")) {
+            settings.numaPlacement = FALSE;
+            isValidArg = TRUE;
+          } else if ( !strcmp(argv[argvIdx],"true") ) {
+            settings.numaPlacement = TRUE;
+            isValidArg = TRUE;
+          }
+        }
+      }
+      if ( !isValidArg ) {
+        STDERR_INFO("Either \"true\" or \"false\" must be used after "
+                    "\"-numa\" option.");
+        RETURN_ERROR;
+      }
+      argvIdx++;
+    }
+
     else if ( !strcmp(argv[argvIdx],"-ratiogtpairs") ) {
       argvIdx++;
       if (argvIdx < argc) {
@@ -605,6 +972,14 @@ int argParser(int argc, char **argv)
                      "(Default is running getting a new seed based on "
                      "current time)");
 
+      fprintf(stdout,"\n  -rng                    "
+                     "\"mt19937\", \"xoshiro256pp\" or \"philox\"             "
+                     "(Default is %s. Random number generator of each thread. "
+                     "The streams of xoshiro256++ (jump-ahead) and Philox "
+                     "(counter-based) never overlap between threads and "
+                     "ranks, and draw bounded integers in batches)",
+              rngTypeName(DEFAULT_RNGTYPE));
+
 #if DEFAULT_NSWAPS == 0
       fprintf(stdout,"\n  -swaps                  "
                      "<number of swaps> or \"elne\"                       "
@@ -643,6 +1018,100 @@ int argParser(int argc, char **argv)
                      "<minimum co-occurence for pair to be relevant>    "
                      "(Default is %u)", DEFAULT_MINRELEVANTCOOC);
 
+      fprintf(stdout,"\n  -coocengine             "
+                     "\"subblocks\", \"spgemm\", \"bitmatrix\" or \"auto\""
+                     "      "
+                     "(Default is %s. Co-occurrence computation by "
+                     "sub-block tiles of the actor lists, by a row-wise "
+                     "sparse product over event-major lists, or by "
+                     "AND+popcount of the adj. matrix rows. \"auto\" chooses "
+                     "between sub-blocks and bit matrix by the edge density)",
+              coocEngineName(DEFAULT_COOCENGINE));
+
+      fprintf(stdout,"\n  -curveballkernel        "
+                     "\"hashed\", \"sorted\", \"stamped\" or \"adaptive\""
+                     "       "
+                     "(Default is %s. Curveball trades through a hashed pool, "
+                     "leaving the lists unsorted, by merging the lists "
+                     "and keeping them sorted, so that they need no sorting "
+                     "before the co-occurrence computation, or through "
+                     "preallocated event stamps, with no memory allocation. "
+                     "\"adaptive\" keeps the lists sorted, and builds the "
+                     "pool of each actor pair by merging, galloping or event "
+                     "stamps, as calibrated at startup)",
+              curveballKernelName(DEFAULT_CURVEBALLKERNEL));
+
+      fprintf(stdout,"\n  -curveballside          "
+                     "\"actors\", \"events\" or \"auto\"                      "
+                     "(Default is %s. Curveball trades between the lists of "
+                     "two actors, or of two events, read through an "
+                     "event-major CSR. \"auto\" trades the side with fewer "
+                     "nodes, i.e. with longer lists. The number of swaps "
+                     "counts trades of that side. Bipartite curveball "
+                     "with a fixed number of swaps only, and neither with "
+                     "global rounds nor with incremental co-occurrence)",
+              curveballSideName(DEFAULT_CURVEBALLSIDE));
+
+      fprintf(stdout,"\n  -edgelookup             "
+                     "\"matrix\", \"hash\" or \"auto\"                        "
+                     "(Default is %s. Edge queries of the single switches "
+                     "through the adjacency bit matrix, of nEvents x nActors "
+                     "bits, or through a hash set of the edges, of O(nEdges) "
+                     "memory. \"auto\" chooses the smaller one once the "
+                     "graph is read. The samples are the same with both. "
+                     "The bit matrix co-occurrence engine, the global "
+                     "single switches and the binary graph files need the "
+                     "matrix)",
+              edgeLookupName(DEFAULT_EDGELOOKUP));
+
+      fprintf(stdout,"\n  -globalcurveball        "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. Each round trades all actors in pairs "
+                     "of a random perfect matching, run concurrently by the "
+                     "threads of the graph (see -threadsperreplica), instead "
+                     "of one thread per graph. The number of swaps is "
+                     "rounded up to whole rounds of nActors/2 trades. "
+                     "Bipartite curveball only)",
+              DEFAULT_GLOBALCURVEBALL ? "true":"false");
+
+      fprintf(stdout,"\n  -globalsingleswitch     "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. The switches of each graph are run "
+                     "concurrently by the threads of the graph (see "
+                     "-threadsperreplica), instead of one thread per graph. "
+                     "Each switch locks the list entries of its two edges, "
+                     "and a switch conflicting with another one is drawn "
+                     "again, so that the results depend on the thread "
+                     "timing, and are not reproducible by the seed. "
+                     "Bipartite single switch only, through the adj. "
+                     "matrix)",
+              DEFAULT_GLOBALSINGLESWITCH ? "true":"false");
+
+      fprintf(stdout,"\n  -incrementalcooc        "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. Each graph keeps its co-occurrence, "
+                     "updated by the curveball trades instead of computed "
+                     "for every sample. Bipartite curveball only, and "
+                     "needs one half matrix per thread)",
+              DEFAULT_INCREMENTALCOOC ? "true":"false");
+
+      fprintf(stdout,"\n  -fusedstats             "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. The co-occurrence of the samples is "
+                     "computed row by row for all graphs at once, and folded "
+                     "into the statistics while the row is in cache, instead "
+                     "of being stored in a half matrix first)",
+              DEFAULT_FUSEDSTATS ? "true":"false");
+      fprintf(stdout,"\n  -persistentround        "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. The swaps and the statistics of a round "
+                     "of samples run in one parallel region, each graph "
+                     "randomized by whichever thread is free, with a single "
+                     "barrier before the rows. Gives the same samples. Fused "
+                     "statistics only, and neither with the global modes nor "
+                     "with pipelined sampling)",
+              DEFAULT_PERSISTENTROUND ? "true":"false");
+
 
 #if DEFAULT_NSAMPLES == 0
       fprintf(stdout,"\n  -samples                "
@@ -658,6 +1127,49 @@ int argParser(int argc, char **argv)
                      "<maximum number of samples>                       "
                      "(Only valid if performing sample heuristic. "
                      "Default is %u)", DEFAULT_NMAXSAMPLES);
+      fprintf(stdout,"\n  -replicas               "
+                     "<number of graphs per rank> or \"auto\"             "
+                     "(Default is auto: as many as threads, as long as "
+                     "they fit in %.0lf%% of the available memory. Graphs "
+                     "randomized concurrently, i.e. samples per round)",
+              100 * REPLICAS_MEMORY_SHARE);
+      fprintf(stdout,"\n  -threadsperreplica      "
+                     "<number of threads per graph> or \"auto\"           "
+                     "(Default is auto: the remaining threads with global "
+                     "curveball or global single switches, and 1 "
+                     "otherwise. Threads randomizing each graph together, "
+                     "global modes only)");
+      fprintf(stdout,"\n  -pipeline               "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. The statistics of a round of samples "
+                     "are computed on snapshots of the graphs, while the "
+                     "graphs are randomized towards the next round. Gives "
+                     "the same samples, and needs one snapshot per graph)",
+              DEFAULT_PIPELINEDSAMPLING ? "true":"false");
+      fprintf(stdout,"\n  -pipelinecoocthreads    "
+                     "<number of threads> or \"auto\"                     "
+                     "(Default is auto: %.0lf%% of the threads. Threads "
+                     "computing the statistics while the others randomize "
+                     "the graphs, pipelined sampling only)",
+              100 * PIPELINE_COOC_THREADS_SHARE);
+      fprintf(stdout,"\n  -numa                   "
+                     "\"true\" or \"false\"                                 "
+                     "(Default is %s. Threads are pinned to the cpus of the "
+                     "rank ordered by NUMA node, each team spread over the "
+                     "cpus of its parent thread, unless OpenMP binds them "
+                     "already (OMP_PROC_BIND, OMP_PLACES). Each graph is "
+                     "then allocated and first written by the thread "
+                     "randomizing it, and the statistics by the threads "
+                     "updating them)",
+              DEFAULT_NUMAPLACEMENT ? "true":"false");
+      fprintf(stdout,"\n  -graphtestinterval      "
+                     "<number of swap steps>                            "
+                     "(Default is %u. The full graph test runs on the first "
+                     "swap step of each graph, and then once every this many "
+                     "steps. The other steps only check the graph in "
+                     "constant time, and the curveball trades check the "
+                     "degrees they keep)",
+              DEFAULT_GRAPHTESTINTERVAL);
       fprintf(stdout,"\n  -ratiogtpairs           "
                      "<length of internal GT/length of result>          "
                      "(Default is %lf)", DEFAULT_RATIOGTPAIRSPERRESULTPAIR);
@@ -715,5 +1227,155 @@ int argParser(int argc, char **argv)
     RETURN_ERROR;
   }
 
+  if ( settings.incrementalCooc
+       && ( !settings.isBipartiteGraph || !settings.runCurveball ) ) {
+    STDERR_INFO("Incremental co-occurrence is only available for bipartite "
+                "graphs randomized by the curveball algorithm.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.globalCurveball
+       && ( !settings.isBipartiteGraph || !settings.runCurveball ) ) {
+    STDERR_INFO("Global curveball is only available for bipartite graphs "
+                "randomized by the curveball algorithm.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.globalCurveball && settings.incrementalCooc ) {
+    // Concurrent trades would update the same co-occurrence half matrix
+    STDERR_INFO("Global curveball and incremental co-occurrence can not be "
+                "used together.");
+    RETURN_ERROR;
+  }
+
+  // The swap heuristic, the global rounds and the incremental co-occurrence
+  //  work on the actor lists, so "auto" falls back to them
+  bool canTradeEventLists = ( settings.isBipartiteGraph && settings.runCurveball
+                              && !settings.runSwapHeuristic
+                              && !settings.globalCurveball
+                              && !settings.incrementalCooc );
+  if ( settings.curveballSide == CURVEBALL_SIDE_AUTO && !canTradeEventLists ) {
+    settings.curveballSide = CURVEBALL_SIDE_ACTORS;
+  }
+  if ( settings.curveballSide == CURVEBALL_SIDE_EVENTS
+       && !canTradeEventLists ) {
+    STDERR_INFO("Event-side curveball is only available for bipartite graphs "
+                "randomized by the curveball algorithm with a given number "
+                "of swaps, and neither with global curveball nor with "
+                "incremental co-occurrence.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.nThreadsPerReplica > 1
+       && !settings.globalCurveball && !settings.globalSingleSwitch ) {
+    STDERR_INFO("Several threads per replica are only available with global "
+                "curveball or global single switches.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.nPipelineCoocThreads > 0 && !settings.pipelinedSampling ) {
+    STDERR_INFO("The threads of the co-occurrence stage can only be given "
+                "with pipelined sampling.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.globalSingleSwitch
+       && ( !settings.isBipartiteGraph || settings.runCurveball ) ) {
+    STDERR_INFO("Global single switches are only available for bipartite "
+                "graphs randomized by single switches.");
+    RETURN_ERROR;
+  }
+
+  // The bit matrix co-occurrence engine and the binary graph files read or
+  //  write the adj. matrix itself, and the global single switches claim its
+  //  bits atomically, so "auto" keeps it for them
+  bool needsAdjMatrix = ( settings.coocEngine == COOC_ENGINE_BITMATRIX
+                          || settings.isBinaryInput
+                          || settings.writeBinaryGraph
+                          || settings.globalSingleSwitch );
+  if ( settings.edgeLookup == EDGE_LOOKUP_AUTO && needsAdjMatrix ) {
+    settings.edgeLookup = EDGE_LOOKUP_MATRIX;
+  }
+  if ( settings.edgeLookup == EDGE_LOOKUP_HASH && needsAdjMatrix ) {
+    STDERR_INFO("The hash edge lookup can be used neither with the bit "
+                "matrix co-occurrence engine, with global single switches "
+                "nor with binary graph files.");
+    RETURN_ERROR;
+  }
+
+  if ( settings.incrementalCooc && settings.fusedStats ) {
+    STDERR_INFO("Incremental co-occurrence and fused statistics can not be "
+                "used together.");
+    RETURN_ERROR;
+  }
+
+  // The round runs one graph per thread, and then the rows of the sparse
+  //  product engine
+  if ( settings.persistentRound
+       && ( !settings.fusedStats || settings.pipelinedSampling
+            || settings.globalCurveball || settings.globalSingleSwitch ) ) {
+    STDERR_INFO("Persistent rounds are only available with fused statistics, "
+                "and neither with the global modes nor with pipelined "
+                "sampling.");
+    RETURN_ERROR;
+  }
+
   return SUCCESS;
 }
+
+// Option value of each co-occurrence engine (see "-coocengine")
+const char* coocEngineName(COOCENGINE coocEngine)
+{
+  switch ( coocEngine ) {
+    case COOC_ENGINE_SUBBLOCKS: return "subblocks";
+    case COOC_ENGINE_SPGEMM:    return "spgemm";
+    case COOC_ENGINE_BITMATRIX: return "bitmatrix";
+    case COOC_ENGINE_AUTO:      return "auto";
+  }
+  return "unknown";
+}
+
+// Option value of each curveball kernel (see "-curveballkernel")
+const char* curveballKernelName(CURVEBALLKERNEL curveballKernel)
+{
+  switch ( curveballKernel ) {
+    case CURVEBALL_KERNEL_HASHED: return "hashed";
+    case CURVEBALL_KERNEL_SORTED: return "sorted";
+    case CURVEBALL_KERNEL_STAMPED: return "stamped";
+    case CURVEBALL_KERNEL_ADAPTIVE: return "adaptive";
+  }
+  return "unknown";
+}
+
+// Option value of each curveball side (see "-curveballside")
+const char* curveballSideName(CURVEBALLSIDE curveballSide)
+{
+  switch ( curveballSide ) {
+    case CURVEBALL_SIDE_ACTORS: return "actors";
+    case CURVEBALL_SIDE_EVENTS: return "events";
+    case CURVEBALL_SIDE_AUTO:   return "auto";
+  }
+  return "unknown";
+}
+
+// Option value of each edge lookup structure (see "-edgelookup")
+const char* edgeLookupName(EDGELOOKUP edgeLookup)
+{
+  switch ( edgeLookup ) {
+    case EDGE_LOOKUP_MATRIX: return "matrix";
+    case EDGE_LOOKUP_HASH:   return "hash";
+    case EDGE_LOOKUP_AUTO:   return "auto";
+  }
+  return "unknown";
+}
+
+// Option value of each random number generator (see "-rng")
+const char* rngTypeName(RNGTYPE rngType)
+{
+  switch ( rngType ) {
+    case RNG_MT19937:      return "mt19937";
+    case RNG_XOSHIRO256PP: return "xoshiro256pp";
+    case RNG_PHILOX4X32:   return "philox";
+  }
+  return "unknown";
+}
@@ -341,13 +341,28 @@ bool readInputBipartite(GRAPH* g, char* inputFile){
   graphInfo.nBlocksAdjMatrix =
       (ulint) graphInfo.nBlocksPerEvent * graphInfo.nEvents;
 
+  // The adj. matrix, or an edge set if smaller (see "-edgelookup")
+  if ( settings.edgeLookup == EDGE_LOOKUP_AUTO ) {
+    settings.edgeLookup = autoSelectEdgeLookup();
+  }
+
   // Allocate memory for graph and graph information
   if ( allocGraph(g) == FAILURE ) { FORWARD_ERROR; }
   if ( allocGraphInfo(&graphInfo) == FAILURE ) { FORWARD_ERROR; }
 
 
   // Create one linked list per actor
-  LIST* actorTmpAdjLists[graphInfo.nActors];
+  // The array is taken from the scratch arena of the master thread, since
+  //  there may be too many actors for the stack
+  SCRATCHARENA* arena = &scratchArena[0];
+  if ( arenaReserve(arena, arenaArraySize(LIST*, graphInfo.nActors))
+       == FAILURE ) {
+    FORWARD_ERROR;
+  }
+  const size_t arenaStart = arenaMark(arena);
+  LIST** actorTmpAdjLists;
+  arenaArray(actorTmpAdjLists, arena, graphInfo.nActors);
+  if ( actorTmpAdjLists == NULL ) { MEM_ERROR; }
   for(uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) { //initialize the array of Lists
     actorTmpAdjLists[actorIt] = ListInit();
   }
@@ -430,6 +445,7 @@ bool readInputBipartite(GRAPH* g, char* inputFile){
 
     graphInfo.coocSum += (listLength * (listLength-1)) / 2;
   }
+  arenaRelease(arena, arenaStart);
 
   // Build adj. matrix
   adjMatrixFromAdjLists( g );
@@ -454,8 +470,10 @@ bool readInputBipartite(GRAPH* g, char* inputFile){
     printEventList();
   #endif
 
+  // Degree sequences, whose largest degrees size the scratch arenas
+  if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
+
   #if TEST_GRAPH
-    if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
     if ( graphTest(g) == FAILURE ) { FORWARD_ERROR; }
   #endif
 
@@ -547,13 +565,28 @@ bool readInputNonBipartite(GRAPH* g, char* inputFile){
   graphInfo.nBlocksAdjMatrix =
       (ulint) graphInfo.nBlocksPerEvent * graphInfo.nEvents;
 
+  // The adj. matrix, or an edge set if smaller (see "-edgelookup")
+  if ( settings.edgeLookup == EDGE_LOOKUP_AUTO ) {
+    settings.edgeLookup = autoSelectEdgeLookup();
+  }
+
   // Allocate memory for graph and graph information
   if ( allocGraph(g) == FAILURE ) { FORWARD_ERROR; }
   if ( allocGraphInfo(&graphInfo) == FAILURE ) { FORWARD_ERROR; }
 
 
   // Create one linked list per node
-  LIST* actorTmpAdjLists[graphInfo.nEvents];
+  // The array is taken from the scratch arena of the master thread, since
+  //  there may be too many nodes for the stack
+  SCRATCHARENA* arena = &scratchArena[0];
+  if ( arenaReserve(arena, arenaArraySize(LIST*, graphInfo.nEvents))
+       == FAILURE ) {
+    FORWARD_ERROR;
+  }
+  const size_t arenaStart = arenaMark(arena);
+  LIST** actorTmpAdjLists;
+  arenaArray(actorTmpAdjLists, arena, graphInfo.nEvents);
+  if ( actorTmpAdjLists == NULL ) { MEM_ERROR; }
   for(uint actorIt = 0; actorIt < graphInfo.nActors; actorIt++) { //initialize the array of Lists
     actorTmpAdjLists[actorIt] = ListInit();
   }
@@ -633,6 +666,7 @@ bool readInputNonBipartite(GRAPH* g, char* inputFile){
 
     graphInfo.coocSum += (listLength * (listLength-1)) / 2;
   }
+  arenaRelease(arena, arenaStart);
   // Additional co-occurence from direct edge (a->b) -> cooc(a,b) += directEdgeV
   graphInfo.coocSum += (graphInfo.nEdges * settings.directEdgeCoocValue) / 2;
 
@@ -659,8 +693,10 @@ bool readInputNonBipartite(GRAPH* g, char* inputFile){
     printEventList();
   #endif
 
+  // Degree sequences, whose largest degrees size the scratch arenas
+  if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
+
   #if TEST_GRAPH
-    if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
     if ( graphTest(g) == FAILURE ) { FORWARD_ERROR; }
   #endif
 
@@ -856,8 +892,10 @@ bool readBinaryGraph(GRAPH* g, char* binFileName)
     printEventList();
   #endif
 
+  // Degree sequences, whose largest degrees size the scratch arenas
+  if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
+
   #if TEST_GRAPH
-    if ( initOriginalNodeDegrees(g) == FAILURE ) { FORWARD_ERROR; }
     if ( graphTest(g) == FAILURE ) { FORWARD_ERROR; }
   #endif
 
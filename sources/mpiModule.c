@@ -42,6 +42,85 @@ void mpiInit (int argc, char** argv)
   MPI_Comm_rank (MPI_COMM_WORLD, &mpiModule.procId);
   /* get number of processes */
   MPI_Comm_size (MPI_COMM_WORLD, &mpiModule.numProcs);
+  /* get number of processes sharing the memory of this node */
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type (MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, mpiModule.procId,
+                       MPI_INFO_NULL, &nodeComm);
+  MPI_Comm_size (nodeComm, &mpiModule.numNodeProcs);
+  MPI_Comm_rank (nodeComm, &mpiModule.nodeProcId);
+  MPI_Comm_free (&nodeComm);
+}
+
+void mpiSetReplicaLayout()
+{
+  const bool isGlobalMode = settings.globalCurveball
+                            || settings.globalSingleSwitch;
+
+  // Pipelined sampling leaves some threads to the statistics, unless the
+  //  replicas are given
+  uint nThreads = omp_get_max_threads();
+  if ( settings.pipelinedSampling && settings.nReplicas == 0 ) {
+    if ( settings.nPipelineCoocThreads == 0 ) {
+      settings.nPipelineCoocThreads =
+          max((uint) (PIPELINE_COOC_THREADS_SHARE * nThreads), 1u);
+      MPI_INFO("Pipeline co-occurrence threads (auto): %u\n",
+               settings.nPipelineCoocThreads);
+    }
+    nThreads = max(nThreads - min(settings.nPipelineCoocThreads, nThreads),
+                   1u);
+  }
+
+  if ( settings.nReplicas == 0 ) {
+    // One replica per thread (or per team of the given size), as long as
+    //  they fit in the share of the available memory of this rank
+    uint nReplicas = max(nThreads / max(settings.nThreadsPerReplica, 1u), 1u);
+    size_t replicaBytes = graphReplicaBytes();
+    double memoryBudget = REPLICAS_MEMORY_SHARE * getAvailableMemory()
+                          / mpiModule.numNodeProcs;
+    // Scratch of the threads, whatever the number of replicas: the dense
+    //  rows of the sparse product, and the trade scratch of the teams of the
+    //  global modes (see threadAllocScratch())
+    double scratchBytes = 0;
+    if ( needsEventAdjLists() ) {
+      scratchBytes += (double) omp_get_max_threads() * graphInfo.nEvents
+                      * sizeof **coocAccumulators;
+    }
+    if ( isGlobalMode ) {
+      scratchBytes += (double) nThreads * threadScratchBytes();
+    }
+    if ( memoryBudget > 0 ) {
+      memoryBudget = max(memoryBudget - scratchBytes, 1.0);
+    }
+    if ( memoryBudget > 0 && replicaBytes > 0 ) { // Unknown memory: no limit
+      double nFittingReplicas = floor(memoryBudget / replicaBytes);
+      nReplicas = min(nReplicas, (uint) max(nFittingReplicas, 1.0));
+    }
+    settings.nReplicas = nReplicas;
+    MPI_INFO("Graph replicas (auto): %u (%.1lf MB each)\n",
+             settings.nReplicas, replicaBytes / 1048576.0);
+  }
+  if ( settings.nThreadsPerReplica == 0 ) {
+    // The threads left by the replicas share their graphs in the global modes
+    settings.nThreadsPerReplica =
+        isGlobalMode ? max(nThreads / settings.nReplicas, 1u) : 1;
+    MPI_INFO("Threads per replica (auto): %u\n", settings.nThreadsPerReplica);
+  }
+
+  if ( settings.pipelinedSampling && settings.nPipelineCoocThreads == 0 ) {
+    // The threads left by the replicas
+    settings.nPipelineCoocThreads =
+        max(omp_get_max_threads() - min(nRankThreads(),
+                                        (uint) omp_get_max_threads()), 1u);
+    MPI_INFO("Pipeline co-occurrence threads (auto): %u\n",
+             settings.nPipelineCoocThreads);
+  }
+
+  // The teams of the global modes run inside the region of the replicas,
+  //  and the pipelined stages run both inside a region of their own
+  uint nActiveLevels = 1 + isGlobalMode + settings.pipelinedSampling;
+  if ( nActiveLevels > 1 ) {
+    omp_set_max_active_levels(nActiveLevels);
+  }
 }
 
 void printRunSettings()
@@ -65,6 +144,7 @@ void printRunSettings()
              settings.ignoreGTMissingNodes ? "yes" : "no");
   }
   MPI_INFO("Random seed: %lu\n", settings.seed);
+  MPI_INFO("Random number generator: %s\n", rngTypeName(settings.rngType));
   if ( settings.isBipartiteGraph ) {
     MPI_INFO("Graph type: bipartite\n");
     if ( settings.bipartiteSideOfInterest == 'l' ) {
@@ -79,10 +159,64 @@ void printRunSettings()
              settings.directEdgeCoocValue);
   }
   if ( settings.runCurveball ) {
-    MPI_INFO("Graph randomization algorithm: curveball\n");
+    MPI_INFO("Graph randomization algorithm: curveball (%s trades%s, "
+             "%s side)\n",
+             curveballKernelName(settings.curveballKernel),
+             settings.globalCurveball ? ", global rounds" : "",
+             curveballSideName(settings.curveballSide));
+    if ( isSortedCurveballKernel() ) {
+      MPI_INFO("Trade pool set intersection: %s\n", markCommonEntriesName);
+    }
+  } else {
+    MPI_INFO("Graph randomization algorithm: single switch%s\n",
+             settings.globalSingleSwitch ? " (global, concurrent)" : "");
+  }
+  if ( settings.nReplicas == 0 ) {
+    MPI_INFO("Graph replicas: auto (memory-aware)\n");
   } else {
-    MPI_INFO("Graph randomization algorithm: single switch\n");
+    MPI_INFO("Graph replicas: %u\n", settings.nReplicas);
   }
+  if ( settings.nThreadsPerReplica == 0 ) {
+    MPI_INFO("Threads per replica: auto\n");
+  } else {
+    MPI_INFO("Threads per replica: %u\n", settings.nThreadsPerReplica);
+  }
+  MPI_INFO("Edge lookup: %s\n", edgeLookupName(settings.edgeLookup));
+  if ( settings.coocEngine == COOC_ENGINE_SPGEMM ) {
+    MPI_INFO("Co-occurrence engine: sparse product (B.B^T)\n");
+    MPI_INFO("Co-occurrence threads: %u\n", coocSchedule.nThreads);
+  } else if ( settings.coocEngine == COOC_ENGINE_BITMATRIX ) {
+    MPI_INFO("Co-occurrence engine: bit matrix (%s)\n", andPopCountBlockName);
+    MPI_INFO("Co-occurrence threads: %u\n", coocSchedule.nThreads);
+  } else {
+    if ( settings.coocEngine == COOC_ENGINE_AUTO ) {
+      MPI_INFO("Co-occurrence engine: auto (sub-block tiles or bit matrix)\n");
+    } else {
+      MPI_INFO("Co-occurrence engine: sub-block tiles\n");
+    }
+    MPI_INFO("Co-occurrence threads: %u (%u sub-blocks, %u tiles)\n",
+             coocSchedule.nThreads, coocSchedule.nSubBlocks,
+             coocSchedule.nTiles);
+  }
+  MPI_INFO("Incremental co-occurrence: %s\n",
+           settings.incrementalCooc ? "yes" : "no");
+  if ( !settings.pipelinedSampling ) {
+    MPI_INFO("Pipelined sampling: no\n");
+  } else if ( settings.nPipelineCoocThreads == 0 ) {
+    MPI_INFO("Pipelined sampling: yes (auto co-occurrence threads)\n");
+  } else {
+    MPI_INFO("Pipelined sampling: yes (%u co-occurrence threads)\n",
+             settings.nPipelineCoocThreads);
+  }
+  MPI_INFO("NUMA placement: %s\n", settings.numaPlacement ? "yes" : "no");
+  #if TEST_GRAPH
+  MPI_INFO("Graph test: every %u swap steps of each graph\n",
+           settings.graphTestInterval);
+  #endif
+  MPI_INFO("Fused statistics: %s\n",
+           settings.fusedStats ? "yes (sparse product rows)" : "no");
+  MPI_INFO("Persistent rounds: %s\n",
+           settings.persistentRound ? "yes (one parallel region)" : "no");
   if ( settings.runSwapHeuristic ) {
     MPI_INFO("Number of swaps: swap heuristic\n");
   }
@@ -112,7 +246,7 @@ void printRunSettings()
   }
 }
 
-ulint mpiRunSwapHeuristic(GRAPH* g, gsl_rng** randG) {
+ulint mpiRunSwapHeuristic(GRAPH* g, RANDGEN** randG) {
 
   // Very small graphs - can afford safe amount of swaps
   if ( graphInfo.nEdges < 100 ) {
@@ -159,12 +293,13 @@ ulint mpiRunSwapHeuristic(GRAPH* g, gsl_rng** randG) {
     if ( settings.runCurveball ) {
       uint randNumber[2];
       for (ulint swap=0; swap < nSwapsStep; ++swap) {
-        randNumber[0] = (uint)gsl_rng_uniform_int(randG[0], graphInfo.nActors);
-        randNumber[1] = (uint)gsl_rng_uniform_int(randG[0], graphInfo.nActors);
+        randNumber[0] = (uint)randUniformInt(randG[0], graphInfo.nActors);
+        randNumber[1] = (uint)randUniformInt(randG[0], graphInfo.nActors);
         while ( randNumber[1] == randNumber[0] ) { // Force different actors
-          randNumber[1] = (uint)gsl_rng_uniform_int(randG[0],graphInfo.nActors);
+          randNumber[1] = (uint)randUniformInt(randG[0],graphInfo.nActors);
         }
-        if( curveballTradeHashedLists( testG, randNumber, randG[0]) == FAILURE )
+        if( curveballTrade( testG, randNumber, randG[0],
+                            &tradeScratch[0]) == FAILURE )
         {
           FORWARD_ERROR_V(0);
         }
@@ -173,8 +308,8 @@ ulint mpiRunSwapHeuristic(GRAPH* g, gsl_rng** randG) {
     } else {
       uint randNumber[2];
       for (ulint swap=0; swap < nSwapsStep; ++swap) {
-        randNumber[0] = (uint) gsl_rng_uniform_int (randG[0], graphInfo.nEdges);
-        randNumber[1] = (uint) gsl_rng_uniform_int (randG[0], graphInfo.nEdges);
+        randNumber[0] = (uint) randUniformInt(randG[0], graphInfo.nEdges);
+        randNumber[1] = (uint) randUniformInt(randG[0], graphInfo.nEdges);
 
         singleSwapBipartite( testG, randNumber);
       }
@@ -283,15 +418,15 @@ ulint mpiRunSwapHeuristic(GRAPH* g, gsl_rng** randG) {
       FORWARD_ERROR_V(0);
     }
   }
-  for ( uint i=0; i<NUMBER_OF_THREADS-1; ++i) {
+  for ( uint i=0; i<settings.nReplicas-1; ++i) {
     perturbation = perturbationMeasure(&g[i], &g[i+1]);
     if ( perturbation == -1 ) { FORWARD_ERROR_V(0); }
     fprintf(stdout, "Graph %u: Pert: %lu\n",
             i, perturbation);
   }
-  perturbation = perturbationMeasure(&g[NUMBER_OF_THREADS-1], &g[0]);
+  perturbation = perturbationMeasure(&g[settings.nReplicas-1], &g[0]);
   if ( perturbation == -1 ) { FORWARD_ERROR_V(0); }
-  fprintf(stdout, "Graph %u: Pert: %lu\n", NUMBER_OF_THREADS-1, perturbation);
+  fprintf(stdout, "Graph %u: Pert: %lu\n", settings.nReplicas-1, perturbation);
 
   return nSwapsNeeded;
 }
@@ -308,6 +443,7 @@ bool mpiRun(int argc, char** argv)
   /* *********************************************************************** */
   /* DECLARE TIME TRACKING VARIABLES */
   TIMER readTimer, coocTimer, swapTimer, mergeTimer, extGtTimer, sampleHeuTimer;
+  TIMER roundTimer;
   /* *********************************************************************** */
 
   /* *********************************************************************** */
@@ -316,6 +452,31 @@ bool mpiRun(int argc, char** argv)
   else if (settings.isHelpRun == TRUE) { return SUCCESS; }
   /* *********************************************************************** */
 
+  /* *********************************************************************** */
+  /* SPLIT CO-OCCURRENCE COMPUTATION AMONG ALL AVAILABLE THREADS */
+  if ( initCoocSchedule(&coocSchedule, omp_get_max_threads()) == FAILURE ) {
+    FORWARD_ERROR;
+  }
+  initCpuFeatures(); // Selects the SIMD kernels
+  /* *********************************************************************** */
+
+  /* *********************************************************************** */
+  /* PIN THREADS TO THE CPUS OF THE RANK, ORDERED BY NUMA NODE */
+  if ( settings.numaPlacement ) {
+    if ( omp_get_proc_bind() != omp_proc_bind_false ) {
+      MPI_INFO("NUMA placement: threads bound by OpenMP (OMP_PROC_BIND)\n");
+    } else {
+      if ( initNumaTopology(mpiModule.nodeProcId, mpiModule.numNodeProcs)
+           == FAILURE ) {
+        FORWARD_ERROR;
+      }
+      threadPin(); // The master thread reads, and so places, the graph
+      MPI_INFO("NUMA placement: threads pinned to %u cpus on %u nodes\n",
+               numaTopology.nCpus, numaTopology.nNodes);
+    }
+  }
+  /* *********************************************************************** */
+
   /* *********************************************************************** */
   /* GET SAMPLING SEEDS */
   if ( !settings.gotExternalSeed ) {
@@ -324,9 +485,6 @@ bool mpiRun(int argc, char** argv)
     settings.seed = seed.tv_nsec;
   }
   MPI_Bcast(&settings.seed, 1, MPI_LONG, 0, MPI_COMM_WORLD);
-  ulint ranksSeed = settings.seed + NUMBER_OF_THREADS * mpiModule.procId;
-  gsl_rng** randGenerator = threadRandInit(ranksSeed);
-  if ( randGenerator == NULL ) { FORWARD_ERROR; }
   /* *********************************************************************** */
 
 
@@ -339,10 +497,14 @@ bool mpiRun(int argc, char** argv)
 
   /* *********************************************************************** */
   /* READ INPUT GRAPH */
-  GRAPH graph[NUMBER_OF_THREADS];
-  for ( uint graphIt=0; graphIt < NUMBER_OF_THREADS; ++graphIt ) {
-    initGraph( &graph[ graphIt ] );
-  }
+  // Only the original graph exists while reading, since the number of
+  //  replicas depends on its size (see mpiSetReplicaLayout())
+  GRAPH* graph;
+  arrayCalloc(graph, 1);
+  if ( graph == NULL ) { MEM_ERROR; }
+  initGraph( &graph[0] );
+  arrayCalloc(scratchArena, 1);
+  if ( scratchArena == NULL ) { MEM_ERROR; }
 
   startTimer(&readTimer);
   char inputFile[MAX_FILEPATH_SIZE+MAX_FILENAME_SIZE];
@@ -350,6 +512,8 @@ bool mpiRun(int argc, char** argv)
   strcat(inputFile, "/");
   strcat(inputFile, settings.inputFileName);
   MPI_INFO("Input file: %s\n", inputFile);
+  // "auto" is resolved by the readers, before allocating the graph
+  bool isAutoEdgeLookup = ( settings.edgeLookup == EDGE_LOOKUP_AUTO );
   if (settings.isBipartiteGraph) {
     if ( readInputBipartite(&graph[0], inputFile) == FAILURE ) {
       FORWARD_ERROR;
@@ -365,6 +529,63 @@ bool mpiRun(int argc, char** argv)
     MPI_INFO("Graph info: #nodes %u, #edges %u (A->B and B->A), cooc sum %lu\n",
             graphInfo.nEvents, graphInfo.nEdges, graphInfo.coocSum);
   }
+  if ( isAutoEdgeLookup ) {
+    MPI_INFO("Edge lookup (auto): %s\n", edgeLookupName(settings.edgeLookup));
+  }
+  if ( settings.coocEngine == COOC_ENGINE_AUTO ) {
+    settings.coocEngine = autoSelectCoocEngine();
+    if ( settings.coocEngine == COOC_ENGINE_BITMATRIX ) {
+      MPI_INFO("Co-occurrence engine (auto): bit matrix (%s)\n",
+               andPopCountBlockName);
+    } else {
+      MPI_INFO("Co-occurrence engine (auto): sub-block tiles\n");
+    }
+  }
+  if ( settings.curveballSide == CURVEBALL_SIDE_AUTO ) {
+    settings.curveballSide = autoSelectCurveballSide();
+    MPI_INFO("Curveball side (auto): %s\n",
+             curveballSideName(settings.curveballSide));
+    if ( needsEventAdjLists() && graph[0].eventAdjLists == NULL ) {
+      if ( allocEventAdjLists(&graph[0]) == FAILURE ) { FORWARD_ERROR; }
+    }
+  }
+  if ( initHeavyActorsSchedule(&coocSchedule) == FAILURE ) { FORWARD_ERROR; }
+  orderCoocTiles(&coocSchedule);
+  if ( settings.coocEngine == COOC_ENGINE_SUBBLOCKS ) {
+    MPI_INFO("Heavy actors: %u (in %u bands of rows)\n",
+             coocSchedule.nHeavyActors, coocSchedule.nHeavyBands);
+  }
+  mpiSetReplicaLayout();
+  GRAPH* replicas = realloc(graph, settings.nReplicas * sizeof *graph);
+  if ( replicas == NULL ) { MEM_ERROR; }
+  graph = replicas;
+  for ( uint graphIt=1; graphIt < settings.nReplicas; ++graphIt ) {
+    initGraph( &graph[ graphIt ] );
+  }
+  if ( threadAllocScratch() == FAILURE ) { FORWARD_ERROR; }
+  // One stream per thread of the rank (see threadRandInit())
+  RANDGEN** randGenerator = threadRandInit(settings.seed, mpiModule.procId);
+  if ( randGenerator == NULL ) { FORWARD_ERROR; }
+  if ( settings.runCurveball
+       && settings.curveballKernel == CURVEBALL_KERNEL_ADAPTIVE ) {
+    // Calibrated once, by the first rank, for all of them
+    bool calibrationStatus = SUCCESS;
+    if ( mpiModule.procId == 0 ) {
+      calibrationStatus = calibrateTradeKernels(&tradeScratch[0]);
+    }
+    MPI_Bcast(&calibrationStatus, 1, MPI_CHAR, 0, MPI_COMM_WORLD);
+    if ( calibrationStatus == FAILURE ) { FORWARD_ERROR; }
+    MPI_Bcast(&intersectionGallopRatio, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&tradeStampMinLength, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    if ( tradeStampMinLength == UINT_MAX ) {
+      MPI_INFO("Adaptive trades (calibrated): galloping above length ratio "
+               "%u, no event stamps\n", intersectionGallopRatio);
+    } else {
+      MPI_INFO("Adaptive trades (calibrated): galloping above length ratio "
+               "%u, event stamps from %u events per actor pair\n",
+               intersectionGallopRatio, tradeStampMinLength);
+    }
+  }
   MPI_INFO("Copying graphs...\n");
   if ( threadCopyGraph(graph) == FAILURE ) { FORWARD_ERROR; }
   if ( getElapsedTime(&readTimer) < 0 ) { FORWARD_ERROR; }
@@ -380,20 +601,50 @@ bool mpiRun(int argc, char** argv)
   /* *********************************************************************** */
 
 
+  /* *********************************************************************** */
+  /* ORIGINAL CO-OCCURRENCE COMPUTATION */
+  MPI_INFO("Calculating original co-occurrence...\n");
+  if ( threadGetOriginalCooc(&graph[0]) == FAILURE ) {FORWARD_ERROR;}
+  MPI_INFO("Original co-occurrence done.\n");
+  MPI_INFO("Number of relevant pairs: %u\n", graphInfo.nRelevantPairs);
+  /* *********************************************************************** */
+
   /* *********************************************************************** */
   /* INITIALIZE CO-OCCURENCE RELEATED STRUCTURES */
+  // Statistics are kept for the relevant pairs only
   TMPRESULT tmpResult;
-  if ( coocHalfMatricesInitialize(&tmpResult, graphInfo.nEvents) == FAILURE ) {
+  if ( tmpResultInitialize(&tmpResult, graphInfo.nEvents) == FAILURE ) {
     FORWARD_ERROR;
   }
+  if ( settings.numaPlacement ) {
+    threadFirstTouchTmpResult(&tmpResult);
+  }
+  if ( tmpResult.roundCooc != NULL ) {
+    MPI_INFO("Statistics counters: 16-bit per round (%s)\n",
+             foldStatisticsBatchName);
+  } else {
+    MPI_INFO("Statistics counters: 64-bit per graph\n");
+  }
   /* *********************************************************************** */
 
   /* *********************************************************************** */
-  /* ORIGINAL CO-OCCURRENCE COMPUTATION */
-  MPI_INFO("Calculating original co-occurrence...\n");
-  if ( threadGetOriginalCooc(&graph[0]) == FAILURE ) {FORWARD_ERROR;}
-  MPI_INFO("Original co-occurrence done.\n");
-  MPI_INFO("Number of relevant pairs: %u\n", graphInfo.nRelevantPairs);
+  /* CO-OCCURRENCE OF EACH GRAPH, UPDATED BY THE TRADES */
+  if ( settings.incrementalCooc ) {
+    if ( threadInitIncrementalCooc(graph) == FAILURE ) { FORWARD_ERROR; }
+  }
+  /* *********************************************************************** */
+
+  /* *********************************************************************** */
+  /* SNAPSHOTS OF THE GRAPHS, FOR THE STATISTICS OF PIPELINED SAMPLING */
+  GRAPH* snapshots = NULL;
+  if ( settings.pipelinedSampling ) {
+    arrayCalloc(snapshots, settings.nReplicas);
+    if ( snapshots == NULL ) { MEM_ERROR; }
+    for ( uint graphIt=0; graphIt < settings.nReplicas; ++graphIt ) {
+      initGraph( &snapshots[ graphIt ] );
+    }
+    if ( threadInitSnapshots(graph, snapshots) == FAILURE ) { FORWARD_ERROR; }
+  }
   /* *********************************************************************** */
 
 //  /* *********************************************************************** */
@@ -440,6 +691,8 @@ bool mpiRun(int argc, char** argv)
   /* *********************************************************************** */
 
   uint rankCurrentSample = 0;
+  // Pipelined sampling randomizes the next samples ahead
+  bool areSamplesRandomized = FALSE;
   /* *********************************************************************** */
   /* GENERATE SEVERAL RANDOM GRAPHS BY THE FDSM */
   while (// Heuristic says to keep sampling (always TRUE if heuristic is not running)
@@ -450,45 +703,79 @@ bool mpiRun(int argc, char** argv)
 
     /* *********************************************************************** */
     /* RE-RANDOMIZE GRAPHS */
-    MPI_INFO("Randomizing samples %u"
-             " until %u. Swaps: %lu \n",
-             rankCurrentSample, (rankCurrentSample + NUMBER_OF_THREADS),
-             settings.nSwaps);
-
-    startTimer(&swapTimer);
-    // Each thread has its own graph and random seed
-    threadRunSwapsStep(graph, randGenerator, settings.nSwaps);
-    if ( accElapsedTime(&swapTimer) == FAILURE ) { FORWARD_ERROR; }
+    if ( settings.persistentRound ) {
+      MPI_INFO("Randomizing samples %u until %u and calculating "
+               "co-occurrence. Swaps: %lu \n",
+               rankCurrentSample, (rankCurrentSample + settings.nReplicas),
+               settings.nSwaps);
+
+      startTimer(&roundTimer);
+      // Swaps and statistics of the round, in one parallel region
+      if ( threadRunSamplingRound(graph, randGenerator, settings.nSwaps,
+                                  &tmpResult) == FAILURE ) {
+        FORWARD_ERROR;
+      }
+      if ( accElapsedTime(&roundTimer) == FAILURE ) { FORWARD_ERROR; }
+    } else if ( !areSamplesRandomized ) {
+      MPI_INFO("Randomizing samples %u"
+               " until %u. Swaps: %lu \n",
+               rankCurrentSample, (rankCurrentSample + settings.nReplicas),
+               settings.nSwaps);
+
+      startTimer(&swapTimer);
+      // Each thread has its own graph and random seed
+      threadRunSwapsStep(graph, randGenerator, settings.nSwaps);
+      if ( accElapsedTime(&swapTimer) == FAILURE ) { FORWARD_ERROR; }
+    }
     MPI_Barrier(MPI_COMM_WORLD);
     /* *********************************************************************** */
 
 
     /* *********************************************************************** */
     /* CALCULATE CO-OCCURRENCES */
-    MPI_INFO("Calculating co-occurrence...\n");
+    if ( settings.pipelinedSampling ) {
+      // The statistics of these samples are computed on their snapshots,
+      //  while the graphs are randomized towards the next ones, unless these
+      //  are the last ones (the sample heuristic may still stop earlier)
+      areSamplesRandomized = ( ( rankCurrentSample + settings.nReplicas )
+                               * mpiModule.numProcs < settings.nSamples );
+      if ( areSamplesRandomized ) {
+        MPI_INFO("Calculating co-occurrence, while randomizing samples %u"
+                 " until %u. Swaps: %lu \n",
+                 rankCurrentSample + settings.nReplicas,
+                 rankCurrentSample + 2 * settings.nReplicas, settings.nSwaps);
+      } else {
+        MPI_INFO("Calculating co-occurrence...\n");
+      }
 
-    startTimer(&coocTimer);
+      startTimer(&coocTimer);
+      if ( threadHandOffSnapshots(graph, snapshots) == FAILURE ) {
+        FORWARD_ERROR;
+      }
+      if ( accElapsedTime(&coocTimer) == FAILURE ) { FORWARD_ERROR; }
 
-    // Re-alloc lastCooc for every new set of samples
-    // This enables the memory exchange between the lastCooc vector and the vector of pairs
-    for(uint row = 0; row < (graphInfo.nEvents-1); row++) {
-      tmpResult.lastCooc[row] = (uint*) calloc ((graphInfo.nEvents - 1 - row), sizeof(uint));
-      if ( tmpResult.lastCooc[row] == NULL ) { FORWARD_ERROR; }
-    }
+      if ( threadRunPipelinedStep(graph, snapshots, randGenerator,
+                                  areSamplesRandomized ? settings.nSwaps : 0,
+                                  &tmpResult, &swapTimer, &coocTimer)
+           == FAILURE ) {
+        FORWARD_ERROR;
+      }
+    } else if ( !settings.persistentRound ) {
+      MPI_INFO("Calculating co-occurrence...\n");
 
-    // Split co-occurrence calculation among threads
-    if ( threadUpdateTmpResult(graph, &tmpResult) == FAILURE ) { FORWARD_ERROR;}
+      startTimer(&coocTimer);
 
-    for (uint row = 0; row < (graphInfo.nEvents - 1); row++) {
-      free(tmpResult.lastCooc[row]);
-      tmpResult.lastCooc[row] = NULL;
-    }
+      // Split co-occurrence calculation among threads
+      if ( threadUpdateTmpResult(graph, &tmpResult) == FAILURE ) {
+        FORWARD_ERROR;
+      }
 
-    if ( accElapsedTime(&coocTimer) == FAILURE ) { FORWARD_ERROR; }
+      if ( accElapsedTime(&coocTimer) == FAILURE ) { FORWARD_ERROR; }
+    }
     /* *********************************************************************** */
 
     // Increment the number of samples already perfomed
-    rankCurrentSample += NUMBER_OF_THREADS;
+    rankCurrentSample += settings.nReplicas;
     MPI_INFO("%u samples done.\n", rankCurrentSample);
 
     MPI_Barrier(MPI_COMM_WORLD);
@@ -501,35 +788,31 @@ bool mpiRun(int argc, char** argv)
       startTimer(&mergeTimer);
       if (mpiModule.procId == 0) {
         // PARENT PROCESS
-        for (uint row = 0; row < (graphInfo.nEvents-1); row++) {
-          MPI_Reduce(MPI_IN_PLACE, tmpResult.coocSum[row], (graphInfo.nEvents - 1 - row),
-                     MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(MPI_IN_PLACE, tmpResult.coocSum, graphInfo.nRelevantPairs,
+                   MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
-          MPI_Reduce(MPI_IN_PLACE, tmpResult.coocSquareSum[row], (graphInfo.nEvents - 1 - row),
-                     MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(MPI_IN_PLACE, tmpResult.coocSquareSum, graphInfo.nRelevantPairs,
+                   MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 
-          MPI_Reduce(MPI_IN_PLACE, tmpResult.pValue[row], (graphInfo.nEvents - 1 - row),
-                     MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-        }
+        MPI_Reduce(MPI_IN_PLACE, tmpResult.pValue, graphInfo.nRelevantPairs,
+                   MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
       }
       else {
         // CHILD PROCESS
-        for (uint row = 0; row < (graphInfo.nEvents - 1); row++) {
-          MPI_Reduce(tmpResult.coocSum[row], tmpResult.coocSum[row],
-                     graphInfo.nEvents - 1 - row,
-                     MPI_LONG, MPI_SUM, 0,
-                     MPI_COMM_WORLD);
-
-          MPI_Reduce(tmpResult.coocSquareSum[row], tmpResult.coocSquareSum[row],
-                     graphInfo.nEvents - 1 - row,
-                     MPI_LONG, MPI_SUM, 0,
-                     MPI_COMM_WORLD);
-
-          MPI_Reduce(tmpResult.pValue[row], tmpResult.pValue[row],
-                     graphInfo.nEvents - 1 - row,
-                     MPI_INT, MPI_SUM, 0,
-                     MPI_COMM_WORLD);
-        }
+        MPI_Reduce(tmpResult.coocSum, tmpResult.coocSum,
+                   graphInfo.nRelevantPairs,
+                   MPI_LONG, MPI_SUM, 0,
+                   MPI_COMM_WORLD);
+
+        MPI_Reduce(tmpResult.coocSquareSum, tmpResult.coocSquareSum,
+                   graphInfo.nRelevantPairs,
+                   MPI_LONG, MPI_SUM, 0,
+                   MPI_COMM_WORLD);
+
+        MPI_Reduce(tmpResult.pValue, tmpResult.pValue,
+                   graphInfo.nRelevantPairs,
+                   MPI_INT, MPI_SUM, 0,
+                   MPI_COMM_WORLD);
       }
       if ( accElapsedTime(&mergeTimer) == FAILURE ) { FORWARD_ERROR; }
     }
@@ -588,12 +871,10 @@ bool mpiRun(int argc, char** argv)
     // while child processes clear their results (already merged)
     else {
       // CHILD PROCESS
-      for (uint row = 0; row < (graphInfo.nEvents - 1); row++) {
-        for (uint col = 0; col < (graphInfo.nEvents - 1 - row); col++) {
-          tmpResult.pValue[row][col] = 0;
-          tmpResult.coocSum[row][col] = 0;
-          tmpResult.coocSquareSum[row][col] = 0;
-        }
+      for (uint pairIt = 0; pairIt < graphInfo.nRelevantPairs; pairIt++) {
+        tmpResult.pValue[pairIt] = 0;
+        tmpResult.coocSum[pairIt] = 0;
+        tmpResult.coocSquareSum[pairIt] = 0;
       }
     }
 
@@ -606,12 +887,20 @@ bool mpiRun(int argc, char** argv)
 
   /* *********************************************************************** */
   /* PRINT OUT MEAN TIMINGS */
-  if ( getTotalElapsedTime(&swapTimer) < 0 ) { FORWARD_ERROR; }
-  MPI_INFO("Mean time per sample used swapping: %lf s\n",
-           swapTimer.totalElapsedTime / rankCurrentSample);
-  if ( getTotalElapsedTime(&coocTimer) < 0 ) { FORWARD_ERROR; }
-  MPI_INFO("Mean time per sample used calculating co-occurrence: %lf s\n",
-           coocTimer.totalElapsedTime / rankCurrentSample);
+  if ( settings.persistentRound ) {
+    // Swaps and co-occurrence overlap in a round
+    if ( getTotalElapsedTime(&roundTimer) < 0 ) { FORWARD_ERROR; }
+    MPI_INFO("Mean time per sample used swapping and calculating "
+             "co-occurrence: %lf s\n",
+             roundTimer.totalElapsedTime / rankCurrentSample);
+  } else {
+    if ( getTotalElapsedTime(&swapTimer) < 0 ) { FORWARD_ERROR; }
+    MPI_INFO("Mean time per sample used swapping: %lf s\n",
+             swapTimer.totalElapsedTime / rankCurrentSample);
+    if ( getTotalElapsedTime(&coocTimer) < 0 ) { FORWARD_ERROR; }
+    MPI_INFO("Mean time per sample used calculating co-occurrence: %lf s\n",
+             coocTimer.totalElapsedTime / rankCurrentSample);
+  }
 
   if ( mpiModule.numProcs > 1 ) {
     if ( getTotalElapsedTime(&mergeTimer) < 0 ) { FORWARD_ERROR; }
@@ -656,6 +945,14 @@ bool mpiRun(int argc, char** argv)
   }
 
   threadDeleteGraph(graph);
+  free(graph);
+  graph = NULL;
+
+  if ( snapshots != NULL ) {
+    threadDeleteGraph(snapshots);
+    free(snapshots);
+    snapshots = NULL;
+  }
 
   if ( settings.runSamplesHeuristic ) {
     freeGT(&internalGt);
@@ -675,22 +972,7 @@ bool mpiRun(int argc, char** argv)
 
   threadRandFree(randGenerator);
 
-  for (uint row = 0; row < (graphInfo.nEvents-1); row++) {
-    free(graphInfo.originalCooc[row]);
-    graphInfo.originalCooc[row] = NULL;
-
-    free(tmpResult.pValue[row]);
-    tmpResult.pValue[row] = NULL;
-
-    free(tmpResult.coocSum[row]);
-    tmpResult.coocSum[row] = NULL;
-
-    free(tmpResult.coocSquareSum[row]);
-    tmpResult.coocSquareSum[row] = NULL;
-  }
-
-  free(graphInfo.originalCooc);
-  graphInfo.originalCooc = NULL;
+  halfMatrixFree(graphInfo.originalCooc, graphInfo.nEvents-1);
 
   free(tmpResult.pValue);
   tmpResult.pValue = NULL;
@@ -701,11 +983,22 @@ bool mpiRun(int argc, char** argv)
   free(tmpResult.coocSquareSum);
   tmpResult.coocSquareSum = NULL;
 
-  free(tmpResult.lastCooc);
-  tmpResult.lastCooc = NULL;
+  halfMatrixFree(tmpResult.lastCooc, graphInfo.nEvents-1);
+
+  free(tmpResult.roundCooc);
+  tmpResult.roundCooc = NULL;
+
+  free(tmpResult.originalNarrowCooc);
+  tmpResult.originalNarrowCooc = NULL;
 
   deleteGraphInfo(&graphInfo);
 
+  deleteCoocSchedule(&coocSchedule);
+
+  threadFreeScratch();
+
+  deleteNumaTopology();
+
   // Destroy global lock if is forced sequential run
   #if FORCE_THREADWISE_SEQUENTIAL_RUN
   omp_destroy_lock(&forceSequentialLock);
@@ -132,12 +132,13 @@ bool createOutput (TMPRESULT* results, PAIR* pairs)
   for (uint pairIt=0; pairIt < graphInfo.nRelevantPairs; pairIt++) {
     uint row = pairs[pairIt].eventId1;
     uint col = pairs[pairIt].eventId2 - row - 1;
+    uint relevantPairId = pairs[pairIt].relevantPairId;
     fprintf(outputFileStream, dataFormatStr,
             graphInfo.eventList[pairs[pairIt].eventId1],
             graphInfo.eventList[pairs[pairIt].eventId2],
             (double)pairs[pairIt].pValue/(double)settings.nSamples,
             pairs[pairIt].zScore,
-            (double)results->coocSum[row][col]/(double)settings.nSamples,
+            (double)results->coocSum[relevantPairId]/(double)settings.nSamples,
             graphInfo.originalCooc[row][col]);
   }
 
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2019, University of Kaiserslautern
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Andre Lucas Chinazzo
+ */
+
+
+#include "../headers/rngModule.h"
+
+static uint64_t splitMix64(uint64_t* state)
+{
+  uint64_t z = ( *state += 0x9E3779B97F4A7C15ULL );
+  z = ( z ^ (z >> 30) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ (z >> 27) ) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static void xoshiroJump(uint64_t* s, const uint64_t* jumpPolynomial)
+{
+  uint64_t jumped[4] = { 0, 0, 0, 0 };
+  for (uint wordIt = 0; wordIt < 4; ++wordIt) {
+    for (uint bitIt = 0; bitIt < 64; ++bitIt) {
+      if ( jumpPolynomial[wordIt] & ( (uint64_t)1 << bitIt ) ) {
+        for (uint stateIt = 0; stateIt < 4; ++stateIt) {
+          jumped[stateIt] ^= s[stateIt];
+        }
+      }
+      xoshiroNext(s);
+    }
+  }
+  memcpy(s, jumped, sizeof jumped);
+}
+
+// Advances 2^128 draws
+static void xoshiroJumpStream(uint64_t* s)
+{
+  static const uint64_t jump[4] = { 0x180ec6d33cfd0abaULL,
+                                    0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL,
+                                    0x39abdc4529b1661cULL };
+  xoshiroJump(s, jump);
+}
+
+// Advances 2^192 draws
+static void xoshiroJumpRank(uint64_t* s)
+{
+  static const uint64_t longJump[4] = { 0x76e15d3efefdcbbfULL,
+                                        0xc5004e441c522fb3ULL,
+                                        0x77710069854ee241ULL,
+                                        0x39109bb02acbe635ULL };
+  xoshiroJump(s, longJump);
+}
+
+void philoxNextBlock(RANDGEN* randG)
+{
+  // Philox4x32-10 of the current counter, which is then incremented
+  uint32_t x[4];
+  uint32_t key[2] = { randG->philoxKey[0], randG->philoxKey[1] };
+  memcpy(x, randG->philoxCounter, sizeof x);
+  for (uint roundIt = 0; roundIt < 10; ++roundIt) {
+    uint64_t product0 = (uint64_t)0xD2511F53 * x[0];
+    uint64_t product1 = (uint64_t)0xCD9E8D57 * x[2];
+    uint32_t next[4] = { (uint32_t)( product1 >> 32 ) ^ x[1] ^ key[0],
+                         (uint32_t) product1,
+                         (uint32_t)( product0 >> 32 ) ^ x[3] ^ key[1],
+                         (uint32_t) product0 };
+    memcpy(x, next, sizeof x);
+    key[0] += 0x9E3779B9;
+    key[1] += 0xBB67AE85;
+  }
+  // Outputs are taken from the last one
+  for (uint outputIt = 0; outputIt < 4; ++outputIt) {
+    randG->philoxOutput[3 - outputIt] = x[outputIt];
+  }
+  randG->nPhiloxOutputsLeft = 4;
+
+  // 64-bit block count in the first two counter words
+  if ( ++randG->philoxCounter[0] == 0 ) {
+    ++randG->philoxCounter[1];
+  }
+}
+
+RANDGEN* randGenAlloc(RNGTYPE type, ulint seed, uint rankId, uint streamId)
+{
+  RANDGEN* randG;
+  arrayCalloc(randG, 1);
+  if ( randG == NULL ) { MEM_ERROR_V(NULL); }
+  randG->type = type;
+
+  switch ( type ) {
+    case RNG_MT19937:
+      randG->gslRandG = gsl_rng_alloc(gsl_rng_mt19937);
+      if ( randG->gslRandG == NULL ) { MEM_ERROR_V(NULL); }
+      gsl_rng_set(randG->gslRandG,
+                  seed + (ulint)settings.nReplicas * settings.nThreadsPerReplica
+                         * rankId + streamId);
+      break;
+
+    case RNG_XOSHIRO256PP: {
+      uint64_t splitMixState = seed;
+      for (uint stateIt = 0; stateIt < 4; ++stateIt) {
+        randG->xoshiroState[stateIt] = splitMix64(&splitMixState);
+      }
+      for (uint rankIt = 0; rankIt < rankId; ++rankIt) {
+        xoshiroJumpRank(randG->xoshiroState);
+      }
+      for (uint streamIt = 0; streamIt < streamId; ++streamIt) {
+        xoshiroJumpStream(randG->xoshiroState);
+      }
+      break;
+    }
+
+    case RNG_PHILOX4X32:
+      randG->philoxKey[0] = (uint32_t) seed;
+      randG->philoxKey[1] = (uint32_t)( (uint64_t)seed >> 32 );
+      randG->philoxCounter[2] = streamId;
+      randG->philoxCounter[3] = rankId;
+      break;
+  }
+
+  return randG;
+}
+
+void randGenFree(RANDGEN* randG)
+{
+  if ( randG != NULL ) {
+    if ( randG->gslRandG != NULL ) {
+      gsl_rng_free(randG->gslRandG);
+    }
+    free(randG);
+  }
+}
+
+void randUniformInts(RANDGEN* randG, uint bound, uint* values, uint nValues)
+{
+  for (uint valueIt = 0; valueIt < nValues; ++valueIt) {
+    values[valueIt] = randUniformInt(randG, bound);
+  }
+}
@@ -111,28 +111,27 @@ void filterResultByGT(GROUNDTRUTH* gt, PAIR* pairs,
   //  is element of the set of nodes of the ground truth
   // !!! Better nomenclature needed !!!
   gt->gtFilteredSetLength = 0;
-  uint relevantPairIt = 0;
   uint filteredSetPairIt = 0;
   for (uint row=0; row<(graphInfo.nEvents-1); row++) {
-    for (uint col=0; col<(graphInfo.nEvents-1-row); col++) {
-      if( graphInfo.originalCooc[row][col] >= settings.minRelevantCooc ) {
-        if(    checkBitOnBlockArray( gt->gtEventsList.blocks, row, 0 )
-            || checkBitOnBlockArray( gt->gtEventsList.blocks, row + col + 1, 0)
-          ) { // <- Choose the ones from which at least one of the nodes is a node of the groud truth
-          // Store event pair info
-          pairs[filteredSetPairIt].eventId1 = row;
-          pairs[filteredSetPairIt].eventId2 = row + col + 1;
-          pairs[filteredSetPairIt].relevantPairId = relevantPairIt;
-          pairs[filteredSetPairIt].pValue = tmpResult->pValue[row][col];
-          pairs[filteredSetPairIt].zScore = zScore_uint(graphInfo.originalCooc[row][col],
-                                                      tmpResult->coocSum[row][col],
-                                                      tmpResult->coocSquareSum[row][col],
-                                                      nSamples);
-          // Increment the iterator of the filtered set
-          filteredSetPairIt++;
-        }
-        // Increment the iterator of the result set
-        relevantPairIt++;
+    // Iterates through the relevant pairs of the row (result set)
+    for (uint relevantPairIt = graphInfo.relevantPairsRowStart[row];
+         relevantPairIt < graphInfo.relevantPairsRowStart[row+1];
+         relevantPairIt++) {
+      uint col = graphInfo.relevantPairsCols[relevantPairIt];
+      if(    checkBitOnBlockArray( gt->gtEventsList.blocks, row, 0 )
+          || checkBitOnBlockArray( gt->gtEventsList.blocks, row + col + 1, 0)
+        ) { // <- Choose the ones from which at least one of the nodes is a node of the groud truth
+        // Store event pair info
+        pairs[filteredSetPairIt].eventId1 = row;
+        pairs[filteredSetPairIt].eventId2 = row + col + 1;
+        pairs[filteredSetPairIt].relevantPairId = relevantPairIt;
+        pairs[filteredSetPairIt].pValue = tmpResult->pValue[relevantPairIt];
+        pairs[filteredSetPairIt].zScore = zScore_uint(graphInfo.originalCooc[row][col],
+                                                    tmpResult->coocSum[relevantPairIt],
+                                                    tmpResult->coocSquareSum[relevantPairIt],
+                                                    nSamples);
+        // Increment the iterator of the filtered set
+        filteredSetPairIt++;
       }
     }
   }
@@ -0,0 +1,656 @@
+/*
+ * Copyright (c) 2019, University of Kaiserslautern
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Andre Lucas Chinazzo
+ */
+
+
+
+#include "../headers/simdModule.h"
+
+// Splits the A.B^T block into TILE_A x TILE_B register tiles
+// Full tiles are handled by the tile kernel inlined with constant sizes
+//  (fully unrolled, accumulators kept in registers); only the edge tiles
+//  use the generic sizes
+#define AND_POPCOUNT_BLOCK_BODY(tileKernel, TILE_A, TILE_B)                   \
+  for (uint _rowA = 0; _rowA < nRowsA; _rowA += (TILE_A)) {                   \
+    uint _nA = min((uint)(TILE_A), nRowsA - _rowA);                           \
+    for (uint _rowB = 0; _rowB < nRowsB; _rowB += (TILE_B)) {                 \
+      uint _nB = min((uint)(TILE_B), nRowsB - _rowB);                         \
+      const BLOCK* _a = &rowsA[ (size_t)_rowA * nWords ];                     \
+      const BLOCK* _b = &rowsB[ (size_t)_rowB * nWords ];                     \
+      uint* _counts = &counts[ (size_t)_rowA * nRowsB + _rowB ];              \
+      if ( _nA == (TILE_A) && _nB == (TILE_B) ) {                             \
+        tileKernel(_a, (TILE_A), _b, (TILE_B), nWords, _counts, nRowsB);      \
+      } else {                                                                \
+        tileKernel(_a, _nA, _b, _nB, nWords, _counts, nRowsB);                \
+      }                                                                       \
+    }                                                                         \
+  }
+
+/* **************************************** */
+/* Scalar kernels */
+#define SCALAR_TILE_A 2
+#define SCALAR_TILE_B 2
+
+static inline __attribute__((always_inline))
+void andPopCountTileScalar(const BLOCK* a, uint nA, const BLOCK* b, uint nB,
+                           uint nWords, uint* counts, uint countsStride)
+{
+  uint acc[SCALAR_TILE_A][SCALAR_TILE_B] = {{0}};
+  for (uint wordIt = 0; wordIt < nWords; ++wordIt) {
+    for (uint r = 0; r < nA; ++r) {
+      for (uint c = 0; c < nB; ++c) {
+        acc[r][c] += __builtin_popcountll(   a[ r * nWords + wordIt ]
+                                           & b[ c * nWords + wordIt ] );
+      }
+    }
+  }
+
+  for (uint r = 0; r < nA; ++r) {
+    for (uint c = 0; c < nB; ++c) {
+      counts[ r * countsStride + c ] = acc[r][c];
+    }
+  }
+}
+
+static void andPopCountBlockScalar(const BLOCK* rowsA, uint nRowsA,
+                                   const BLOCK* rowsB, uint nRowsB,
+                                   uint nWords, uint* counts)
+{
+  AND_POPCOUNT_BLOCK_BODY(andPopCountTileScalar, SCALAR_TILE_A, SCALAR_TILE_B);
+}
+
+// Same kernel, with the builtin expanded into the popcnt instruction
+__attribute__((target("popcnt")))
+static void andPopCountBlockPopcnt(const BLOCK* rowsA, uint nRowsA,
+                                   const BLOCK* rowsB, uint nRowsB,
+                                   uint nWords, uint* counts)
+{
+  AND_POPCOUNT_BLOCK_BODY(andPopCountTileScalar, SCALAR_TILE_A, SCALAR_TILE_B);
+}
+/* **************************************** */
+
+/* **************************************** */
+/* AVX2 kernels */
+// Harley-Seal needs 4 accumulators per pair of rows (ones, twos, fours and
+//  the total), so the register tile is a single row of A against two of B
+#define AVX2_TILE_A 1
+#define AVX2_TILE_B 2
+
+// Per 64-bit lane popcount through a nibble lookup table (Mula)
+static inline __attribute__((always_inline, target("avx2")))
+__m256i popCount256(__m256i v)
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                          1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3,
+                                          1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  __m256i low = _mm256_and_si256(v, lowMask);
+  __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+  __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                  _mm256_shuffle_epi8(lookup, high));
+  return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+uint64_t horizontalSum256(__m256i v)
+{
+  __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v),
+                              _mm256_extracti128_si256(v, 1));
+  return (uint64_t)_mm_cvtsi128_si64(sum) + (uint64_t)_mm_extract_epi64(sum, 1);
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+__m256i loadAnd256(const BLOCK* a, const BLOCK* b, uint wordIt)
+{
+  return _mm256_and_si256(_mm256_loadu_si256((const __m256i*) &a[wordIt]),
+                          _mm256_loadu_si256((const __m256i*) &b[wordIt]));
+}
+
+// Carry-save adder: a + b + c = 2 * high + low (bitwise)
+#define CSA256(high, low, a, b, c) {                                          \
+    __m256i _a = (a), _b = (b), _c = (c);                                     \
+    __m256i _u = _mm256_xor_si256(_a, _b);                                    \
+    (high) = _mm256_or_si256(_mm256_and_si256(_a, _b),                        \
+                             _mm256_and_si256(_u, _c));                       \
+    (low) = _mm256_xor_si256(_u, _c); }
+
+static inline __attribute__((always_inline, target("avx2,popcnt")))
+void andPopCountTileAvx2(const BLOCK* a, uint nA, const BLOCK* b, uint nB,
+                         uint nWords, uint* counts, uint countsStride)
+{
+  for (uint r = 0; r < nA; ++r) {
+    const BLOCK* rowA = &a[ (size_t)r * nWords ];
+
+    __m256i ones[AVX2_TILE_B], twos[AVX2_TILE_B], fours[AVX2_TILE_B];
+    __m256i total[AVX2_TILE_B];
+    for (uint c = 0; c < nB; ++c) {
+      ones[c] = twos[c] = fours[c] = total[c] = _mm256_setzero_si256();
+    }
+
+    // Harley-Seal: each 8 vectors are reduced by a carry-save adder tree,
+    //  and only the resulting "eights" vector is popcounted
+    uint wordIt = 0;
+    for (; wordIt + 32 <= nWords; wordIt += 32) {
+      for (uint c = 0; c < nB; ++c) {
+        const BLOCK* rowB = &b[ (size_t)c * nWords ];
+        __m256i twosA, twosB, foursA, foursB, eights;
+        CSA256(twosA, ones[c], ones[c], loadAnd256(rowA, rowB, wordIt),
+                                        loadAnd256(rowA, rowB, wordIt + 4));
+        CSA256(twosB, ones[c], ones[c], loadAnd256(rowA, rowB, wordIt + 8),
+                                        loadAnd256(rowA, rowB, wordIt + 12));
+        CSA256(foursA, twos[c], twos[c], twosA, twosB);
+        CSA256(twosA, ones[c], ones[c], loadAnd256(rowA, rowB, wordIt + 16),
+                                        loadAnd256(rowA, rowB, wordIt + 20));
+        CSA256(twosB, ones[c], ones[c], loadAnd256(rowA, rowB, wordIt + 24),
+                                        loadAnd256(rowA, rowB, wordIt + 28));
+        CSA256(foursB, twos[c], twos[c], twosA, twosB);
+        CSA256(eights, fours[c], fours[c], foursA, foursB);
+        total[c] = _mm256_add_epi64(total[c], popCount256(eights));
+      }
+    }
+
+    for (uint c = 0; c < nB; ++c) {
+      const BLOCK* rowB = &b[ (size_t)c * nWords ];
+      __m256i sum = _mm256_slli_epi64(total[c], 3);
+      sum = _mm256_add_epi64(sum,
+                             _mm256_slli_epi64(popCount256(fours[c]), 2));
+      sum = _mm256_add_epi64(sum,
+                             _mm256_slli_epi64(popCount256(twos[c]), 1));
+      sum = _mm256_add_epi64(sum, popCount256(ones[c]));
+
+      // Remaining vectors, then remaining words
+      uint tailIt = wordIt;
+      for (; tailIt + 4 <= nWords; tailIt += 4) {
+        sum = _mm256_add_epi64(sum, popCount256(loadAnd256(rowA, rowB, tailIt)));
+      }
+      uint64_t count = horizontalSum256(sum);
+      for (; tailIt < nWords; ++tailIt) {
+        count += __builtin_popcountll( rowA[tailIt] & rowB[tailIt] );
+      }
+      counts[ r * countsStride + c ] = count;
+    }
+  }
+}
+
+__attribute__((target("avx2,popcnt")))
+static void andPopCountBlockAvx2(const BLOCK* rowsA, uint nRowsA,
+                                 const BLOCK* rowsB, uint nRowsB,
+                                 uint nWords, uint* counts)
+{
+  AND_POPCOUNT_BLOCK_BODY(andPopCountTileAvx2, AVX2_TILE_A, AVX2_TILE_B);
+}
+/* **************************************** */
+
+/* **************************************** */
+/* AVX-512 kernels */
+// One accumulator per pair of rows: 8 accumulators and 6 loaded vectors
+//  fit comfortably into the 32 vector registers
+#define AVX512_TILE_A 4
+#define AVX512_TILE_B 2
+
+static inline __attribute__((always_inline,
+                             target("avx512f,avx512vpopcntdq")))
+void andPopCountTileAvx512(const BLOCK* a, uint nA, const BLOCK* b, uint nB,
+                           uint nWords, uint* counts, uint countsStride)
+{
+  __m512i acc[AVX512_TILE_A][AVX512_TILE_B];
+  for (uint r = 0; r < nA; ++r) {
+    for (uint c = 0; c < nB; ++c) {
+      acc[r][c] = _mm512_setzero_si512();
+    }
+  }
+
+  for (uint wordIt = 0; wordIt < nWords; wordIt += 8) {
+    // Masked loads handle the last, partial, vector
+    __mmask8 mask = ( nWords - wordIt >= 8 )
+                    ? (__mmask8) 0xFF
+                    : (__mmask8) ((1u << (nWords - wordIt)) - 1);
+    __m512i vectorB[AVX512_TILE_B];
+    for (uint c = 0; c < nB; ++c) {
+      vectorB[c] = _mm512_maskz_loadu_epi64(mask, &b[ c * nWords + wordIt ]);
+    }
+    for (uint r = 0; r < nA; ++r) {
+      __m512i vectorA = _mm512_maskz_loadu_epi64(mask,
+                                                 &a[ r * nWords + wordIt ]);
+      for (uint c = 0; c < nB; ++c) {
+        acc[r][c] = _mm512_add_epi64(acc[r][c],
+                      _mm512_popcnt_epi64(_mm512_and_si512(vectorA,
+                                                           vectorB[c])));
+      }
+    }
+  }
+
+  for (uint r = 0; r < nA; ++r) {
+    for (uint c = 0; c < nB; ++c) {
+      counts[ r * countsStride + c ] = _mm512_reduce_add_epi64(acc[r][c]);
+    }
+  }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void andPopCountBlockAvx512(const BLOCK* rowsA, uint nRowsA,
+                                   const BLOCK* rowsB, uint nRowsB,
+                                   uint nWords, uint* counts)
+{
+  AND_POPCOUNT_BLOCK_BODY(andPopCountTileAvx512, AVX512_TILE_A, AVX512_TILE_B);
+}
+/* **************************************** */
+
+/* **************************************** */
+/* Statistics kernels */
+// Scalar version, also used for the last pairs of the vector versions
+static inline __attribute__((always_inline))
+void foldStatisticsPairsScalar(const uint16_t* batchCooc, size_t batchStride,
+                               uint nGraphs, const uint16_t* originalCooc,
+                               uint firstPair, uint nPairs,
+                               ulint* coocSum, ulint* coocSquareSum,
+                               uint* pValue)
+{
+  for (uint pairIt = firstPair; pairIt < nPairs; ++pairIt) {
+    uint sum = 0;
+    ulint squareSum = 0;
+    uint count = 0;
+    uint original = originalCooc[pairIt];
+    for (uint graphIt = 0; graphIt < nGraphs; ++graphIt) {
+      uint cooc = batchCooc[ graphIt * batchStride + pairIt ];
+      sum += cooc;
+      squareSum += cooc * cooc;
+      count += ( original < cooc ) + ( original == cooc ) * ( graphIt % 2 );
+    }
+    coocSum[pairIt] += sum;
+    coocSquareSum[pairIt] += squareSum;
+    pValue[pairIt] += count;
+  }
+}
+
+static void foldStatisticsBatchScalar(const uint16_t* batchCooc,
+                                      size_t batchStride, uint nGraphs,
+                                      const uint16_t* originalCooc,
+                                      uint nPairs, ulint* coocSum,
+                                      ulint* coocSquareSum, uint* pValue)
+{
+  foldStatisticsPairsScalar(batchCooc, batchStride, nGraphs, originalCooc,
+                            0, nPairs, coocSum, coocSquareSum, pValue);
+}
+
+// 8 pairs per vector: co-occurrences are widened to 32-bit lanes,
+//  whose squares (< 2^32) are accumulated in 64-bit lanes
+// Values fit in 16 bits, so the signed comparisons are safe
+__attribute__((target("avx2")))
+static void foldStatisticsBatchAvx2(const uint16_t* batchCooc,
+                                    size_t batchStride, uint nGraphs,
+                                    const uint16_t* originalCooc,
+                                    uint nPairs, ulint* coocSum,
+                                    ulint* coocSquareSum, uint* pValue)
+{
+  uint pairIt = 0;
+  for (; pairIt + 8 <= nPairs; pairIt += 8) {
+    __m256i original = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i*) &originalCooc[pairIt]));
+    __m256i sum = _mm256_setzero_si256();
+    __m256i count = _mm256_setzero_si256();
+    __m256i squareSumLow = _mm256_setzero_si256();
+    __m256i squareSumHigh = _mm256_setzero_si256();
+    for (uint graphIt = 0; graphIt < nGraphs; ++graphIt) {
+      __m256i cooc = _mm256_cvtepu16_epi32(_mm_loadu_si128(
+          (const __m128i*) &batchCooc[ graphIt * batchStride + pairIt ]));
+      sum = _mm256_add_epi32(sum, cooc);
+      __m256i square = _mm256_mullo_epi32(cooc, cooc);
+      squareSumLow = _mm256_add_epi64(squareSumLow,
+          _mm256_cvtepu32_epi64(_mm256_castsi256_si128(square)));
+      squareSumHigh = _mm256_add_epi64(squareSumHigh,
+          _mm256_cvtepu32_epi64(_mm256_extracti128_si256(square, 1)));
+      // Comparison masks are -1, so they are subtracted
+      count = _mm256_sub_epi32(count, _mm256_cmpgt_epi32(cooc, original));
+      if ( graphIt % 2 ) {
+        count = _mm256_sub_epi32(count, _mm256_cmpeq_epi32(cooc, original));
+      }
+    }
+
+    // Promotion to the wide statistics
+    __m256i* coocSumIt = (__m256i*) &coocSum[pairIt];
+    __m256i* coocSquareSumIt = (__m256i*) &coocSquareSum[pairIt];
+    __m256i* pValueIt = (__m256i*) &pValue[pairIt];
+    _mm256_storeu_si256(coocSumIt, _mm256_add_epi64(
+        _mm256_loadu_si256(coocSumIt),
+        _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sum))));
+    _mm256_storeu_si256(coocSumIt + 1, _mm256_add_epi64(
+        _mm256_loadu_si256(coocSumIt + 1),
+        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sum, 1))));
+    _mm256_storeu_si256(coocSquareSumIt, _mm256_add_epi64(
+        _mm256_loadu_si256(coocSquareSumIt), squareSumLow));
+    _mm256_storeu_si256(coocSquareSumIt + 1, _mm256_add_epi64(
+        _mm256_loadu_si256(coocSquareSumIt + 1), squareSumHigh));
+    _mm256_storeu_si256(pValueIt, _mm256_add_epi32(
+        _mm256_loadu_si256(pValueIt), count));
+  }
+
+  foldStatisticsPairsScalar(batchCooc, batchStride, nGraphs, originalCooc,
+                            pairIt, nPairs, coocSum, coocSquareSum, pValue);
+}
+
+// Same as the AVX2 version, with 16 pairs per vector and mask registers
+__attribute__((target("avx512f")))
+static void foldStatisticsBatchAvx512(const uint16_t* batchCooc,
+                                      size_t batchStride, uint nGraphs,
+                                      const uint16_t* originalCooc,
+                                      uint nPairs, ulint* coocSum,
+                                      ulint* coocSquareSum, uint* pValue)
+{
+  const __m512i one = _mm512_set1_epi32(1);
+  uint pairIt = 0;
+  for (; pairIt + 16 <= nPairs; pairIt += 16) {
+    __m512i original = _mm512_cvtepu16_epi32(
+        _mm256_loadu_si256((const __m256i*) &originalCooc[pairIt]));
+    __m512i sum = _mm512_setzero_si512();
+    __m512i count = _mm512_setzero_si512();
+    __m512i squareSumLow = _mm512_setzero_si512();
+    __m512i squareSumHigh = _mm512_setzero_si512();
+    for (uint graphIt = 0; graphIt < nGraphs; ++graphIt) {
+      __m512i cooc = _mm512_cvtepu16_epi32(_mm256_loadu_si256(
+          (const __m256i*) &batchCooc[ graphIt * batchStride + pairIt ]));
+      sum = _mm512_add_epi32(sum, cooc);
+      __m512i square = _mm512_mullo_epi32(cooc, cooc);
+      squareSumLow = _mm512_add_epi64(squareSumLow,
+          _mm512_cvtepu32_epi64(_mm512_castsi512_si256(square)));
+      squareSumHigh = _mm512_add_epi64(squareSumHigh,
+          _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(square, 1)));
+      __mmask16 countMask = _mm512_cmpgt_epi32_mask(cooc, original);
+      if ( graphIt % 2 ) {
+        countMask |= _mm512_cmpeq_epi32_mask(cooc, original);
+      }
+      count = _mm512_mask_add_epi32(count, countMask, count, one);
+    }
+
+    // Promotion to the wide statistics
+    _mm512_storeu_si512(&coocSum[pairIt], _mm512_add_epi64(
+        _mm512_loadu_si512(&coocSum[pairIt]),
+        _mm512_cvtepu32_epi64(_mm512_castsi512_si256(sum))));
+    _mm512_storeu_si512(&coocSum[pairIt + 8], _mm512_add_epi64(
+        _mm512_loadu_si512(&coocSum[pairIt + 8]),
+        _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(sum, 1))));
+    _mm512_storeu_si512(&coocSquareSum[pairIt], _mm512_add_epi64(
+        _mm512_loadu_si512(&coocSquareSum[pairIt]), squareSumLow));
+    _mm512_storeu_si512(&coocSquareSum[pairIt + 8], _mm512_add_epi64(
+        _mm512_loadu_si512(&coocSquareSum[pairIt + 8]), squareSumHigh));
+    _mm512_storeu_si512(&pValue[pairIt], _mm512_add_epi32(
+        _mm512_loadu_si512(&pValue[pairIt]), count));
+  }
+
+  foldStatisticsPairsScalar(batchCooc, batchStride, nGraphs, originalCooc,
+                            pairIt, nPairs, coocSum, coocSquareSum, pValue);
+}
+/* **************************************** */
+
+/* **************************************** */
+/* Sorted set kernels */
+// Merge of the lists from listA[idxA] and listB[idxB] on, used by the scalar
+//  version and for the last entries of the vector versions
+static inline __attribute__((always_inline))
+uint markCommonEntriesMerge(const uint* listA, uint idxA, uint lengthA,
+                            const uint* listB, uint idxB, uint lengthB,
+                            uint8_t* isCommonA, uint8_t* isCommonB)
+{
+  uint nCommon = 0;
+  while ( idxA < lengthA && idxB < lengthB ) {
+    if ( listA[idxA] < listB[idxB] ) {
+      ++idxA;
+    } else if ( listB[idxB] < listA[idxA] ) {
+      ++idxB;
+    } else {
+      isCommonA[idxA / 8] |= (uint8_t)( 1u << (idxA % 8) );
+      isCommonB[idxB / 8] |= (uint8_t)( 1u << (idxB % 8) );
+      ++nCommon;
+      ++idxA;
+      ++idxB;
+    }
+  }
+  return nCommon;
+}
+
+// Each entry of the short list is searched in the long list from the
+//  position of the previous one, by doubling steps and then a binary search
+static uint markCommonEntriesGalloping(const uint* shortList,
+                                       uint shortLength,
+                                       const uint* longList, uint longLength,
+                                       uint8_t* isCommonShort,
+                                       uint8_t* isCommonLong)
+{
+  uint nCommon = 0;
+  uint low = 0;
+  for (uint shortIdx = 0; shortIdx < shortLength && low < longLength;
+       ++shortIdx) {
+    uint value = shortList[shortIdx];
+    uint step = 1;
+    while ( low + step < longLength && longList[low + step] < value ) {
+      low += step;
+      step *= 2;
+    }
+    // First entry not lower than the value, in [low, low + step]
+    uint high = min(low + step, longLength);
+    while ( low < high ) {
+      uint middle = low + (high - low) / 2;
+      if ( longList[middle] < value ) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    if ( low < longLength && longList[low] == value ) {
+      isCommonShort[shortIdx / 8] |= (uint8_t)( 1u << (shortIdx % 8) );
+      isCommonLong[low / 8] |= (uint8_t)( 1u << (low % 8) );
+      ++nCommon;
+      ++low;
+    }
+  }
+  return nCommon;
+}
+
+// Clears the bitmaps, and returns TRUE if the intersection was done by
+//  galloping because the lengths are too skewed for block compares
+static inline __attribute__((always_inline))
+bool markCommonEntriesSetup(const uint* listA, uint lengthA,
+                            const uint* listB, uint lengthB,
+                            uint8_t* isCommonA, uint8_t* isCommonB,
+                            uint* nCommon)
+{
+  memset(isCommonA, 0, (lengthA + 7) / 8);
+  memset(isCommonB, 0, (lengthB + 7) / 8);
+  if ( (ulint)lengthA > (ulint)intersectionGallopRatio * lengthB ) {
+    *nCommon = markCommonEntriesGalloping(listB, lengthB, listA, lengthA,
+                                          isCommonB, isCommonA);
+    return TRUE;
+  }
+  if ( (ulint)lengthB > (ulint)intersectionGallopRatio * lengthA ) {
+    *nCommon = markCommonEntriesGalloping(listA, lengthA, listB, lengthB,
+                                          isCommonA, isCommonB);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static uint markCommonEntriesScalar(const uint* listA, uint lengthA,
+                                    const uint* listB, uint lengthB,
+                                    uint8_t* isCommonA, uint8_t* isCommonB)
+{
+  uint nCommon;
+  if ( markCommonEntriesSetup(listA, lengthA, listB, lengthB,
+                              isCommonA, isCommonB, &nCommon) ) {
+    return nCommon;
+  }
+  return markCommonEntriesMerge(listA, 0, lengthA, listB, 0, lengthB,
+                                isCommonA, isCommonB);
+}
+
+// Blocks of 8 entries of each list are compared all-against-all by
+//  comparing the A block with the 8 rotations of the B block. The block with
+//  the lower last entry can not match any later entry of the other list, so
+//  it is the one replaced (both, if equal)
+// A match in rotation r of A lane i is B lane (i + r) % 8, so the B mask is
+//  the A mask rotated left by r
+__attribute__((target("avx2")))
+static uint markCommonEntriesAvx2(const uint* listA, uint lengthA,
+                                  const uint* listB, uint lengthB,
+                                  uint8_t* isCommonA, uint8_t* isCommonB)
+{
+  uint nCommon;
+  if ( markCommonEntriesSetup(listA, lengthA, listB, lengthB,
+                              isCommonA, isCommonB, &nCommon) ) {
+    return nCommon;
+  }
+
+  nCommon = 0;
+  const __m256i rotateByOne = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+  uint idxA = 0;
+  uint idxB = 0;
+  while ( idxA + 8 <= lengthA && idxB + 8 <= lengthB ) {
+    __m256i blockA = _mm256_loadu_si256((const __m256i*) &listA[idxA]);
+    __m256i blockB = _mm256_loadu_si256((const __m256i*) &listB[idxB]);
+    uint maskA = 0;
+    uint maskB = 0;
+    for (uint r = 0; r < 8; ++r) {
+      uint mask = (uint) _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(blockA, blockB)));
+      maskA |= mask;
+      maskB |= ( ( mask << r ) | ( mask >> ( (8 - r) % 8 ) ) ) & 0xFF;
+      blockB = _mm256_permutevar8x32_epi32(blockB, rotateByOne);
+    }
+    // Blocks start at multiples of 8, i.e. at whole bytes of the bitmaps
+    isCommonA[idxA / 8] |= (uint8_t) maskA;
+    isCommonB[idxB / 8] |= (uint8_t) maskB;
+    nCommon += __builtin_popcount(maskA);
+
+    uint lastA = listA[idxA + 7];
+    uint lastB = listB[idxB + 7];
+    idxA += ( lastA <= lastB ) * 8;
+    idxB += ( lastB <= lastA ) * 8;
+  }
+
+  return nCommon + markCommonEntriesMerge(listA, idxA, lengthA,
+                                          listB, idxB, lengthB,
+                                          isCommonA, isCommonB);
+}
+
+// Same as the AVX2 version, with blocks of 16 entries and mask registers
+__attribute__((target("avx512f")))
+static uint markCommonEntriesAvx512(const uint* listA, uint lengthA,
+                                    const uint* listB, uint lengthB,
+                                    uint8_t* isCommonA, uint8_t* isCommonB)
+{
+  uint nCommon;
+  if ( markCommonEntriesSetup(listA, lengthA, listB, lengthB,
+                              isCommonA, isCommonB, &nCommon) ) {
+    return nCommon;
+  }
+
+  nCommon = 0;
+  uint idxA = 0;
+  uint idxB = 0;
+  while ( idxA + 16 <= lengthA && idxB + 16 <= lengthB ) {
+    __m512i blockA = _mm512_loadu_si512(&listA[idxA]);
+    __m512i blockB = _mm512_loadu_si512(&listB[idxB]);
+    uint maskA = 0;
+    uint maskB = 0;
+    for (uint r = 0; r < 16; ++r) {
+      uint mask = (uint) _mm512_cmpeq_epi32_mask(blockA, blockB);
+      maskA |= mask;
+      maskB |= ( ( mask << r ) | ( mask >> ( (16 - r) % 16 ) ) ) & 0xFFFF;
+      blockB = _mm512_alignr_epi32(blockB, blockB, 1);
+    }
+    // Blocks start at multiples of 16, i.e. at whole byte pairs
+    isCommonA[idxA / 8]     |= (uint8_t) maskA;
+    isCommonA[idxA / 8 + 1] |= (uint8_t)( maskA >> 8 );
+    isCommonB[idxB / 8]     |= (uint8_t) maskB;
+    isCommonB[idxB / 8 + 1] |= (uint8_t)( maskB >> 8 );
+    nCommon += __builtin_popcount(maskA);
+
+    uint lastA = listA[idxA + 15];
+    uint lastB = listB[idxB + 15];
+    idxA += ( lastA <= lastB ) * 16;
+    idxB += ( lastB <= lastA ) * 16;
+  }
+
+  return nCommon + markCommonEntriesMerge(listA, idxA, lengthA,
+                                          listB, idxB, lengthB,
+                                          isCommonA, isCommonB);
+}
+/* **************************************** */
+
+void initCpuFeatures()
+{
+  __builtin_cpu_init();
+  cpuFeatures.popcnt          = ( __builtin_cpu_supports("popcnt") != 0 );
+  cpuFeatures.avx2            = ( __builtin_cpu_supports("avx2") != 0 );
+  cpuFeatures.avx512f         = ( __builtin_cpu_supports("avx512f") != 0 );
+  cpuFeatures.avx512bw        = ( __builtin_cpu_supports("avx512bw") != 0 );
+  cpuFeatures.avx512vpopcntdq =
+      ( __builtin_cpu_supports("avx512vpopcntdq") != 0 );
+
+  if ( cpuFeatures.avx512vpopcntdq ) {
+    andPopCountBlock = andPopCountBlockAvx512;
+    andPopCountBlockName = "AVX-512 VPOPCNTDQ";
+  } else if ( cpuFeatures.avx2 && cpuFeatures.popcnt ) {
+    andPopCountBlock = andPopCountBlockAvx2;
+    andPopCountBlockName = "AVX2 Harley-Seal";
+  } else if ( cpuFeatures.popcnt ) {
+    andPopCountBlock = andPopCountBlockPopcnt;
+    andPopCountBlockName = "scalar popcnt";
+  } else {
+    andPopCountBlock = andPopCountBlockScalar;
+    andPopCountBlockName = "scalar";
+  }
+
+  if ( cpuFeatures.avx512f ) {
+    foldStatisticsBatch = foldStatisticsBatchAvx512;
+    foldStatisticsBatchName = "AVX-512";
+  } else if ( cpuFeatures.avx2 ) {
+    foldStatisticsBatch = foldStatisticsBatchAvx2;
+    foldStatisticsBatchName = "AVX2";
+  } else {
+    foldStatisticsBatch = foldStatisticsBatchScalar;
+    foldStatisticsBatchName = "scalar";
+  }
+
+  intersectionGallopRatio = INTERSECTION_GALLOP_RATIO;
+  if ( cpuFeatures.avx512f ) {
+    markCommonEntries = markCommonEntriesAvx512;
+    markCommonEntriesName = "AVX-512";
+  } else if ( cpuFeatures.avx2 ) {
+    markCommonEntries = markCommonEntriesAvx2;
+    markCommonEntriesName = "AVX2";
+  } else {
+    markCommonEntries = markCommonEntriesScalar;
+    markCommonEntriesName = "scalar";
+  }
+}
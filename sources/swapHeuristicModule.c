@@ -163,13 +163,32 @@ void findMostSparseArray(uint* set, uint setSize,
 int selectEvents(GRAPH* g, uint** seletedNodes)
 {
   uint degreeFrequencyIt;
-  
-  uint eventDegrees[graphInfo.nEvents];
+
+  // Arrays are taken from the scratch arena of the master thread, reserved
+  //  for the largest sizes they may have
+  SCRATCHARENA* arena = &scratchArena[0];
+  size_t arenaSize = arenaArraySize(uint, graphInfo.nEvents)
+                     + 2 * arenaArraySize(uint, graphInfo.maxEventDegree + 1)
+                     + 2 * arenaArraySize(uint, settings.nDegreesSwapHeuristic);
+  if ( arenaReserve(arena, arenaSize) == FAILURE ) { FORWARD_ERROR; }
+  const size_t arenaStart = arenaMark(arena);
+
+  uint* eventDegrees;
+  arenaArray(eventDegrees, arena, graphInfo.nEvents);
+  if ( eventDegrees == NULL ) { MEM_ERROR; }
   uint maxDegree=0;
 
   for(uint eventIt=0; eventIt < graphInfo.nEvents; eventIt++) {
-    eventDegrees[eventIt] = getNodeDegreeViaAdjMatrix(g, eventIt, "event");
-    if ( eventDegrees[eventIt] == 0 ) { FORWARD_ERROR; }
+    // Degrees are kept by the swaps: without the matrix, the original ones
+    if ( g->adjMatrix != NULL ) {
+      eventDegrees[eventIt] = getNodeDegreeViaAdjMatrix(g, eventIt, "event");
+    } else {
+      eventDegrees[eventIt] = graphInfo.eventDegrees[eventIt];
+    }
+    if ( eventDegrees[eventIt] == 0 ) {
+      arenaRelease(arena, arenaStart);
+      FORWARD_ERROR;
+    }
     if ( eventDegrees[eventIt] > maxDegree ) {
       maxDegree = eventDegrees[eventIt];
     }
@@ -183,7 +202,12 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
   }
   #endif
 
-  uint degreeFrequencies[ maxDegree + 1 ];
+  uint* degreeFrequencies;
+  arenaArray(degreeFrequencies, arena, maxDegree + 1);
+  if ( degreeFrequencies == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
   for (degreeFrequencyIt = 0; degreeFrequencyIt < (maxDegree + 1); degreeFrequencyIt++) {
     degreeFrequencies[degreeFrequencyIt] = 0;
   }
@@ -225,6 +249,7 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
                 settings.nEventsPerDegreeSwapHeuristic,
                 settings.nDegreesSwapHeuristic
                 );
+    arenaRelease(arena, arenaStart);
     FORWARD_ERROR;
   }
 
@@ -244,7 +269,8 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
   }
   #endif
 
-  uint degreesAboveThreshold[nDegreesWithFrequencyAboveThreshold];
+  uint* degreesAboveThreshold;
+  arenaArray(degreesAboveThreshold, arena, nDegreesWithFrequencyAboveThreshold);
   uint degreesAboveThresholdIt = 0;
   for (uint degreeFrequencyIt = 0; degreeFrequencyIt <= maxDegreeWithFrequencyAboveThreshold; degreeFrequencyIt++) {
     if( degreeFrequencies[degreeFrequencyIt] >= settings.nEventsPerDegreeSwapHeuristic ) {
@@ -253,7 +279,12 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
     }
   }
 
-  uint selectedDegrees[settings.nDegreesSwapHeuristic];
+  uint* selectedDegrees;
+  arenaArray(selectedDegrees, arena, settings.nDegreesSwapHeuristic);
+  if ( degreesAboveThreshold == NULL || selectedDegrees == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
   uint minSelectedDegree = maxDegreeWithFrequencyAboveThreshold / settings.nDegreesSwapHeuristic + 1;
   // Check if have enough degrees >= the min and decrease min until we have enough
   uint firstDegreeIdx = 0;
@@ -297,7 +328,12 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
   }
   #endif
 
-  uint count[settings.nDegreesSwapHeuristic];
+  uint* count;
+  arenaArray(count, arena, settings.nDegreesSwapHeuristic);
+  if ( count == NULL ) {
+    arenaRelease(arena, arenaStart);
+    MEM_ERROR;
+  }
   for (degreeFrequencyIt=0; degreeFrequencyIt < settings.nDegreesSwapHeuristic; degreeFrequencyIt++) {
     count[degreeFrequencyIt] = 0;
   }
@@ -331,6 +367,7 @@ int selectEvents(GRAPH* g, uint** seletedNodes)
   }
   #endif
 
+  arenaRelease(arena, arenaStart);
   return SUCCESS;
 
 }
@@ -352,7 +389,7 @@ void selectiveCoocCalc (GRAPH* g, TMPSWAPHEURESULT* tmpSwapHeuResult, uint** sel
                                      * (settings.nDegreesSwapHeuristic-1)
                                      / 2;
 
-  for (uint graphIt = 0; graphIt < NUMBER_OF_THREADS; graphIt++) {
+  for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
     for(uint degreeIt1 = 0; degreeIt1 < settings.nDegreesSwapHeuristic-1; degreeIt1++) {
       for(uint degreeIt2 = degreeIt1+1; degreeIt2 < settings.nDegreesSwapHeuristic; degreeIt2++) {
         for(uint eventIt1 = 0; eventIt1  < settings.nEventsPerDegreeSwapHeuristic; eventIt1 ++) {
@@ -33,6 +33,7 @@
  */
 
 
+#define _GNU_SOURCE // sched_setaffinity() and the CPU_* macros
 #include "../headers/threadModule.h"
 
 // Helper functions
@@ -42,6 +43,7 @@ void threadInit(OPENMP* openMP)
   openMP->threadId = omp_get_thread_num();
   openMP->nThreads = omp_get_num_threads();
   openMP->nProcs = omp_get_num_procs();
+  threadPin();
 
   #if FORCE_THREADWISE_SEQUENTIAL_RUN
   omp_set_lock(&forceSequentialLock); //Lock at start of parallel region
@@ -103,45 +105,232 @@ void threadEnd()
 }
 
 
+uint nRankThreads()
+{
+  // Every thread of the rank has its own random stream and scratch, whether
+  //  it randomizes a graph of its own or shares it with its team
+  return settings.nReplicas * settings.nThreadsPerReplica;
+}
+
+// Cpu range the calling thread is pinned to, so that the threads reused by
+//  the next regions skip the system call when their range does not change
+// libgomp keeps it per system thread, as is the affinity
+static uint pinnedFirstCpu = UINT_MAX;
+static uint pinnedLastCpu = UINT_MAX;
+#pragma omp threadprivate(pinnedFirstCpu, pinnedLastCpu)
+
+void threadPin()
+{
+  if ( numaTopology.nCpus == 0 ) { return; } // Threads are not pinned
+
+  // Each team splits the cpus of its parent thread evenly among its threads,
+  //  as the "spread" binding policy of OpenMP does, so that a team (such as
+  //  the threads of a replica) stays on the cpus, and node, of its parent
+  // The serial parts run on the cpu of thread 0
+  uint firstCpu = 0;
+  uint lastCpu = ( omp_get_level() == 0 ) ? 1 : numaTopology.nCpus;
+  for (int level = 1; level <= omp_get_level(); level++) {
+    uint teamSize = omp_get_team_size(level);
+    uint threadNum = omp_get_ancestor_thread_num(level);
+    if ( level == 1 && teamSize == 2 && numaTopology.nSwapStageCpus > 0 ) {
+      // Pipelined stages
+      if ( threadNum == 0 ) {
+        lastCpu = firstCpu + numaTopology.nSwapStageCpus;
+      } else {
+        firstCpu += numaTopology.nSwapStageCpus;
+      }
+      continue;
+    }
+    uint nCpus = lastCpu - firstCpu;
+    uint threadFirstCpu = firstCpu + threadNum * nCpus / teamSize;
+    uint threadLastCpu = firstCpu + (threadNum + 1) * nCpus / teamSize;
+    firstCpu = threadFirstCpu;
+    lastCpu = max(threadLastCpu, threadFirstCpu + 1); // Shared cpu
+  }
+  if ( firstCpu == pinnedFirstCpu && lastCpu == pinnedLastCpu ) { return; }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (uint cpuIt = firstCpu; cpuIt < lastCpu; cpuIt++) {
+    CPU_SET(numaTopology.cpus[cpuIt], &cpuSet);
+  }
+  if ( sched_setaffinity(0, sizeof cpuSet, &cpuSet) == 0 ) { // Best effort
+    pinnedFirstCpu = firstCpu;
+    pinnedLastCpu = lastCpu;
+  }
+}
+
 // Interface functions
-gsl_rng** threadRandInit(ulint seed)
+bool initNumaTopology(uint nodeProcId, uint nNodeProcs)
 {
-  gsl_rng **randG;
-  arrayCalloc(randG, omp_get_max_threads());
+  numaTopology.nCpus = 0;
+  numaTopology.nNodes = 0;
+  numaTopology.cpus = NULL;
+  numaTopology.nSwapStageCpus = 0;
+
+  cpu_set_t allowedCpus;
+  if ( sched_getaffinity(0, sizeof allowedCpus, &allowedCpus) != 0 ) {
+    STDERR_INFO("Could not get the cpus the rank may run on.");
+    RETURN_ERROR;
+  }
+  uint nAllowedCpus = CPU_COUNT(&allowedCpus);
+
+  // Node of every cpu, from its list of cpu ranges (such as "0-7,16-23")
+  // All cpus are on node 0 if the system does not tell
+  uint cpuNodes[CPU_SETSIZE];
+  memset(cpuNodes, 0, sizeof cpuNodes);
+  uint maxNodeId = 0;
+  for (uint nodeIt = 0; nodeIt < NUMA_MAX_NODES; nodeIt++) {
+    char cpuListFileName[64];
+    sprintf(cpuListFileName, "/sys/devices/system/node/node%u/cpulist", nodeIt);
+    FILE* cpuListFile = fopen(cpuListFileName, "r");
+    if ( cpuListFile == NULL ) { continue; } // Node IDs may have gaps
+    uint firstCpu, lastCpu;
+    while ( fscanf(cpuListFile, "%u", &firstCpu) == 1 ) {
+      lastCpu = firstCpu;
+      int separator = fgetc(cpuListFile);
+      if ( separator == '-' ) {
+        if ( fscanf(cpuListFile, "%u", &lastCpu) != 1 ) { break; }
+        separator = fgetc(cpuListFile);
+      }
+      for (uint cpuIt = firstCpu; cpuIt <= lastCpu && cpuIt < CPU_SETSIZE;
+           cpuIt++) {
+        cpuNodes[cpuIt] = nodeIt;
+      }
+      if ( separator != ',' ) { break; }
+    }
+    fclose(cpuListFile);
+    maxNodeId = nodeIt;
+  }
+
+  // Allowed cpus, ordered by node
+  uint* cpus;
+  arrayCalloc(cpus, nAllowedCpus);
+  if ( cpus == NULL ) { MEM_ERROR; }
+  uint nCpus = 0;
+  uint nNodes = 0;
+  for (uint nodeIt = 0; nodeIt <= maxNodeId; nodeIt++) {
+    uint nodeFirstCpu = nCpus;
+    for (uint cpuIt = 0; cpuIt < CPU_SETSIZE && nCpus < nAllowedCpus; cpuIt++) {
+      if ( CPU_ISSET(cpuIt, &allowedCpus) && cpuNodes[cpuIt] == nodeIt ) {
+        cpus[nCpus++] = cpuIt;
+      }
+    }
+    nNodes += ( nCpus > nodeFirstCpu );
+  }
+
+  // Ranks sharing a node which the launcher did not bind get a share each
+  uint firstCpu = 0;
+  if ( nNodeProcs > 1
+       && nCpus == (uint) sysconf(_SC_NPROCESSORS_ONLN) ) {
+    firstCpu = min(nodeProcId * nCpus / nNodeProcs, nCpus - 1);
+    nCpus = max((nodeProcId + 1) * nCpus / nNodeProcs - firstCpu, 1u);
+    memmove(cpus, &cpus[firstCpu], nCpus * sizeof *cpus);
+    nNodes = 0;
+    for (uint cpuIt = 0; cpuIt < nCpus; cpuIt++) {
+      nNodes += ( cpuIt == 0 || cpuNodes[cpus[cpuIt]] != cpuNodes[cpus[cpuIt-1]] );
+    }
+  }
+
+  numaTopology.nCpus = nCpus;
+  numaTopology.nNodes = nNodes;
+  numaTopology.cpus = cpus;
+
+  return SUCCESS;
+}
+
+void deleteNumaTopology()
+{
+  free(numaTopology.cpus);
+  numaTopology.cpus = NULL;
+  numaTopology.nCpus = 0;
+}
+
+RANDGEN** threadRandInit(ulint seed, uint rankId)
+{
+  RANDGEN **randG;
+  arrayCalloc(randG, nRankThreads());
   if ( randG == NULL ) { MEM_ERROR_V(NULL); }
 
-  #pragma omp parallel
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(nRankThreads())
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    randG[openMP.threadId] = gsl_rng_alloc(gsl_rng_mt19937);
-    gsl_rng_set(randG[openMP.threadId], openMP.threadId + seed);
+    // One stream per thread of the rank, and one more for randC, even if
+    //  fewer threads were granted
+    #pragma omp for nowait schedule(static, 1) //See threadInit()
+    for (uint threadIt = 0; threadIt < nRankThreads(); threadIt++) {
+      randG[threadIt] = randGenAlloc(settings.rngType, seed, rankId, threadIt);
+      if ( randG[threadIt] == NULL ) { returnFlag = FAILURE; }
+    }
 
     #pragma omp master
     {
-      randC = gsl_rng_alloc(gsl_rng_mt19937);
-      gsl_rng_set(randC, openMP.nThreads + seed);
+      randC = randGenAlloc(settings.rngType, seed, rankId, nRankThreads());
+      if ( randC == NULL ) { returnFlag = FAILURE; }
     }
 
     threadEnd();
   }
+  if ( returnFlag == FAILURE ) { FORWARD_ERROR_V(NULL); }
 
   return randG;
 }
 
+bool threadAllocScratch()
+{
+  // The arena of the master thread is kept, since the input readers already
+  //  reserved it (see scratchArena)
+  SCRATCHARENA* arenas;
+  arrayCalloc(arenas, nRankThreads());
+  if ( arenas == NULL ) { MEM_ERROR; }
+  arenas[0] = scratchArena[0];
+  free(scratchArena);
+  scratchArena = arenas;
+
+  arrayCalloc(tradeScratch, nRankThreads());
+  if ( tradeScratch == NULL ) { MEM_ERROR; }
+  if ( needsTradeScratch() ) {
+    for ( uint threadIt=0; threadIt < nRankThreads(); ++threadIt ) {
+      if ( allocTradeScratch(&tradeScratch[threadIt],
+                             &scratchArena[threadIt]) == FAILURE ) {
+        FORWARD_ERROR;
+      }
+    }
+  }
+
+  // Co-occurrence regions have all threads, or those of the pipelined stage
+  if ( needsEventAdjLists() ) {
+    nCoocAccumulators = max((uint) omp_get_max_threads(),
+                            max(nRankThreads(), settings.nPipelineCoocThreads));
+    arrayCalloc(coocAccumulators, nCoocAccumulators);
+    if ( coocAccumulators == NULL ) { MEM_ERROR; }
+    for ( uint threadIt=0; threadIt < nCoocAccumulators; ++threadIt ) {
+      arrayCalloc(coocAccumulators[threadIt], graphInfo.nEvents);
+      if ( coocAccumulators[threadIt] == NULL ) { MEM_ERROR; }
+    }
+  }
+
+  return SUCCESS;
+}
+
 bool threadCopyGraph(GRAPH* g)
 {
   bool returnFlag = SUCCESS; // Avoid use of expensive omp cancel
-  #pragma omp parallel
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    if (openMP.threadId != 0) {
-      if ( copyGraph(&g[openMP.threadId], &g[0]) == FAILURE ) {
-        STDERR_INFO("Thread %u: error while copying graph.",
-                    openMP.threadId);
+    // Graphs of each thread, the same ones it randomizes, even if fewer
+    //  threads than graphs were granted
+    #pragma omp for nowait schedule(static, 1) //See threadInit()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      if ( graphIt != 0 && copyGraph(&g[graphIt], &g[0]) == FAILURE ) {
+        STDERR_INFO("Thread %u: error while copying graph %u.",
+                    openMP.threadId, graphIt);
         returnFlag = FAILURE;
       }
     }
@@ -156,7 +345,36 @@ bool threadGetOriginalCooc(GRAPH* g)
 {
 
   // Get original co-occurance
-  threadGetCooc( g, graphInfo.originalCooc );
+  if ( threadGetCooc( g, graphInfo.originalCooc ) == FAILURE ) {
+    FORWARD_ERROR;
+  }
+
+  #if TEST_COOC_ENGINE
+  {
+    // Reference: sub-block kernel
+    uint** referenceCooc;
+    halfMatrixCalloc(referenceCooc, graphInfo.nEvents-1);
+    if ( referenceCooc == NULL ) { MEM_ERROR; }
+    COOCENGINE selectedEngine = settings.coocEngine;
+    settings.coocEngine = COOC_ENGINE_SUBBLOCKS;
+    if ( threadGetCooc( g, referenceCooc ) == FAILURE ) { FORWARD_ERROR; }
+    settings.coocEngine = selectedEngine;
+
+    ulint nDifferentPairs = 0;
+    for (uint row=0; row<(graphInfo.nEvents-1); row++) {
+      for (uint col=0; col<(graphInfo.nEvents-1-row); col++) {
+        nDifferentPairs +=
+            ( referenceCooc[row][col] != graphInfo.originalCooc[row][col] );
+      }
+    }
+    halfMatrixFree(referenceCooc, graphInfo.nEvents-1);
+    if ( nDifferentPairs > 0 ) {
+      STDERR_INFO("Unexpected behavior - co-occurrence engine differs from the "
+                  "sub-block one for %lu pairs!", nDifferentPairs);
+      RETURN_ERROR;
+    }
+  }
+  #endif
 
   // Check sum and extract the number of relevant pairs
   ulint originalCoocSum = 0;
@@ -202,11 +420,128 @@ bool threadGetOriginalCooc(GRAPH* g)
     RETURN_ERROR;
   }
 
+  if ( buildRelevantPairsIndex(&graphInfo) == FAILURE ) { FORWARD_ERROR; }
+
   return SUCCESS;
 
 }
 
-bool threadRunSwapsStep(GRAPH* g, gsl_rng **randGenerator, ulint nSwaps)
+bool threadInitIncrementalCooc(GRAPH* g)
+{
+  // Every graph starts as a copy of the original one,
+  //  and so does its co-occurrence
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      GRAPH* thisG = &g[graphIt];
+      halfMatrixCalloc(thisG->cooc, graphInfo.nEvents-1);
+      if ( thisG->cooc == NULL ) {
+        STDERR_INFO("Thread %u: could not allocate co-occurrence of graph "
+                    "%u.", openMP.threadId, graphIt);
+        returnFlag = FAILURE;
+      } else {
+        memcpy(thisG->cooc[0], graphInfo.originalCooc[0],
+               halfMatrixSize(graphInfo.nEvents - 1) * sizeof(uint));
+      }
+    }
+
+    threadEnd();
+  }
+
+  return returnFlag;
+}
+
+bool threadInitSnapshots(GRAPH* g, GRAPH* snapshots)
+{
+  // Snapshots are laid out as the graphs, with their own co-occurrence in
+  //  the incremental mode (see threadHandOffSnapshots())
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      GRAPH* snapshot = &snapshots[graphIt];
+      if ( copyGraph(snapshot, &g[graphIt]) == FAILURE ) {
+        STDERR_INFO("Thread %u: error while copying graph %u into its "
+                    "snapshot.", openMP.threadId, graphIt);
+        returnFlag = FAILURE;
+      } else if ( settings.incrementalCooc ) {
+        halfMatrixCalloc(snapshot->cooc, graphInfo.nEvents-1);
+        if ( snapshot->cooc == NULL ) {
+          STDERR_INFO("Thread %u: could not allocate co-occurrence of the "
+                      "snapshot of graph %u.", openMP.threadId, graphIt);
+          returnFlag = FAILURE;
+        }
+      }
+    }
+
+    threadEnd();
+  }
+
+  return returnFlag;
+}
+
+void threadFirstTouchTmpResult(TMPRESULT* tmpResult)
+{
+  // Pages are placed on the node of the thread writing them first: every
+  //  array is cleared by the threads which update it, with the same static
+  //  schedules (see threadUpdateTmpResult()), so that rows, and statistics,
+  //  are split among the nodes as the threads are
+  #pragma omp parallel
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static) //See threadInit()
+    for (uint row=0; row<(graphInfo.nEvents-1); row++) {
+      if ( tmpResult->lastCooc != NULL ) {
+        memset(tmpResult->lastCooc[row], 0,
+               (graphInfo.nEvents-1-row) * sizeof(uint));
+      }
+      for (uint pairIt = graphInfo.relevantPairsRowStart[row];
+           pairIt < graphInfo.relevantPairsRowStart[row+1]; pairIt++) {
+        if ( tmpResult->roundCooc != NULL ) {
+          for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+            tmpResult->roundCooc[
+                (size_t)graphIt * graphInfo.nRelevantPairs + pairIt ] = 0;
+          }
+        } else {
+          tmpResult->coocSum[pairIt] = 0;
+          tmpResult->coocSquareSum[pairIt] = 0;
+          tmpResult->pValue[pairIt] = 0;
+        }
+      }
+    }
+
+    // Statistics folded by chunks of pairs (see foldRoundStatistics())
+    if ( tmpResult->roundCooc != NULL ) {
+      #pragma omp for nowait schedule(static) //See threadInit()
+      for (uint firstPairId = 0; firstPairId < graphInfo.nRelevantPairs;
+           firstPairId += STATISTICS_FOLD_CHUNK) {
+        uint nPairs = min((uint)STATISTICS_FOLD_CHUNK,
+                          graphInfo.nRelevantPairs - firstPairId);
+        memset(&tmpResult->coocSum[firstPairId], 0,
+               nPairs * sizeof *tmpResult->coocSum);
+        memset(&tmpResult->coocSquareSum[firstPairId], 0,
+               nPairs * sizeof *tmpResult->coocSquareSum);
+        memset(&tmpResult->pValue[firstPairId], 0,
+               nPairs * sizeof *tmpResult->pValue);
+      }
+    }
+
+    threadEnd();
+  }
+}
+
+bool threadRunSwapsStep(GRAPH* g, RANDGEN **randGenerator, ulint nSwaps)
 {
   if (settings.isBipartiteGraph) {
     if ( settings.runCurveball ) {
@@ -228,13 +563,126 @@ bool threadRunSwapsStep(GRAPH* g, gsl_rng **randGenerator, ulint nSwaps)
   return SUCCESS;
 }
 
+bool threadHandOffSnapshots(GRAPH* g, GRAPH* snapshots)
+{
+  // The lists are sorted, and the links of non-bipartite edges updated, as
+  //  the co-occurrence computation does in a sequential run, so that the
+  //  swaps of the next samples start from the same graphs
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      GRAPH* thisG = &g[graphIt];
+      if ( !thisG->sortedActorAdjLists ) {
+        for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+          sortActorAdjList( thisG, actorIt );
+        }
+        thisG->sortedActorAdjLists = TRUE;
+      }
+
+      if ( settings.isBipartiteGraph == FALSE ) {
+        for (uint edgeIt = 0; edgeIt < graphInfo.nEdges; ++edgeIt) {
+          thisG->edgeLinks[edgeIt] = findLinkedEgde( thisG, edgeIt );
+          //Handle reported error through impossible value
+          if ( thisG->edgeLinks[edgeIt] == graphInfo.nEdges ) {
+            returnFlag = FAILURE;
+            break;
+          }
+        }
+      }
+
+      copyGraphData( &snapshots[graphIt], thisG );
+    }
+
+    threadEnd();
+  }
+
+  return returnFlag;
+}
+
+bool threadRunPipelinedStep(GRAPH* g, GRAPH* snapshots, RANDGEN** randG,
+                            ulint nSwaps, TMPRESULT* tmpResult,
+                            TIMER* swapTimer, TIMER* coocTimer)
+{
+  // Two stages side by side, each one with its own threads: the swaps
+  //  towards the next samples on the graphs (latency bound), and the
+  //  statistics of the current samples on their snapshots (bandwidth bound)
+  bool swapStatus = SUCCESS;
+  bool coocStatus = SUCCESS;
+  // Pinned threads: cpus of the stages in proportion to their threads
+  if ( numaTopology.nCpus > 1 ) {
+    uint nStageCpus = numaTopology.nCpus * nRankThreads()
+                      / ( nRankThreads() + settings.nPipelineCoocThreads );
+    numaTopology.nSwapStageCpus = min(max(nStageCpus, 1u),
+                                      numaTopology.nCpus - 1);
+  }
+  #pragma omp parallel sections num_threads(2)
+  {
+    #pragma omp section
+    {
+      if ( nSwaps > 0 ) {
+        startTimer(swapTimer);
+        swapStatus = threadRunSwapsStep(g, randG, nSwaps);
+        if ( accElapsedTime(swapTimer) == FAILURE ) { swapStatus = FAILURE; }
+      }
+    }
+
+    #pragma omp section
+    {
+      // Team size of the co-occurrence regions opened by this thread
+      omp_set_num_threads(settings.nPipelineCoocThreads);
+      startTimer(coocTimer);
+      coocStatus = threadUpdateTmpResult(snapshots, tmpResult);
+      if ( accElapsedTime(coocTimer) == FAILURE ) { coocStatus = FAILURE; }
+    }
+  }
+  numaTopology.nSwapStageCpus = 0;
+  if ( swapStatus == FAILURE || coocStatus == FAILURE ) { FORWARD_ERROR; }
+
+  return SUCCESS;
+}
+
 bool threadUpdateTmpResult(GRAPH* g, TMPRESULT* tmpResult)
 {
-  // TODO: change to NUMBER_OF_GRAPHS or so
-  for ( uint graphIt = 0; graphIt < NUMBER_OF_THREADS; graphIt++) {
+  if ( settings.fusedStats ) {
+    return threadUpdateTmpResultFused(g, tmpResult);
+  }
+
+  for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
 
     // Get graph cooc
-    threadGetCooc( &g[graphIt], tmpResult->lastCooc );
+    // Incremental mode: kept up to date by the trades of the graph itself
+    uint** lastCooc = tmpResult->lastCooc;
+    if ( settings.incrementalCooc ) {
+      lastCooc = g[graphIt].cooc;
+      #if TEST_COOC_ENGINE
+      {
+        if ( threadGetCooc( &g[graphIt], tmpResult->lastCooc ) == FAILURE ) {
+          FORWARD_ERROR;
+        }
+        ulint nDifferentPairs = 0;
+        for (uint row=0; row<(graphInfo.nEvents-1); row++) {
+          for (uint col=0; col<(graphInfo.nEvents-1-row); col++) {
+            nDifferentPairs +=
+                ( tmpResult->lastCooc[row][col] != lastCooc[row][col] );
+            tmpResult->lastCooc[row][col] = 0;
+          }
+        }
+        if ( nDifferentPairs > 0 ) {
+          STDERR_INFO("Unexpected behavior - incremental co-occurrence of "
+                      "graph %u differs from the computed one for %lu pairs!",
+                      graphIt, nDifferentPairs);
+          RETURN_ERROR;
+        }
+      }
+      #endif
+    } else if ( threadGetCooc( &g[graphIt], lastCooc ) == FAILURE ) {
+      FORWARD_ERROR;
+    }
 
     ulint coocSum = 0;
     #pragma omp parallel
@@ -243,22 +691,43 @@ bool threadUpdateTmpResult(GRAPH* g, TMPRESULT* tmpResult)
       threadInit(&openMP);
 
       ulint localThreadCoocSum = 0; // Simple sum reduction
-      #pragma omp for nowait schedule(auto) //See threadInit()
+      // Same rows for every graph (see threadFirstTouchTmpResult())
+      #pragma omp for nowait schedule(static) //See threadInit()
       for (uint row=0; row<(graphInfo.nEvents-1); row++) {
+        // Statistics of the relevant pairs of the row
+        if ( tmpResult->roundCooc != NULL ) {
+          // Folded with the other graphs (see foldRoundStatistics())
+          uint16_t* graphRoundCooc = &tmpResult->roundCooc[
+              (size_t)graphIt * graphInfo.nRelevantPairs ];
+          for (uint pairIt = graphInfo.relevantPairsRowStart[row];
+               pairIt < graphInfo.relevantPairsRowStart[row+1]; pairIt++) {
+            graphRoundCooc[pairIt] =
+                lastCooc[row][ graphInfo.relevantPairsCols[pairIt] ];
+          }
+        } else {
+          for (uint pairIt = graphInfo.relevantPairsRowStart[row];
+               pairIt < graphInfo.relevantPairsRowStart[row+1]; pairIt++) {
+            uint col = graphInfo.relevantPairsCols[pairIt];
+            tmpResult->coocSum[pairIt] += lastCooc[row][col];
+            tmpResult->coocSquareSum[pairIt] +=
+                lastCooc[row][col] * lastCooc[row][col];
+            if(graphInfo.originalCooc[row][col] < lastCooc[row][col]) {
+              tmpResult->pValue[pairIt]++;
+            } else
+            if(graphInfo.originalCooc[row][col] == lastCooc[row][col]){
+              // Pseudo .5/.5 rand. Graphs must be independent, so are these
+              //  cases. This also ensures exactly equal results for equal
+              //  rand. seeds
+              tmpResult->pValue[pairIt] += (graphIt % 2);
+            }
+          }
+        }
+        // Check sum over all pairs of the row
         for (uint col=0; col<(graphInfo.nEvents-1-row); col++) {
-          tmpResult->coocSum[row][col] += tmpResult->lastCooc[row][col];
-          tmpResult->coocSquareSum[row][col] +=
-              tmpResult->lastCooc[row][col] * tmpResult->lastCooc[row][col];
-          if(graphInfo.originalCooc[row][col] < tmpResult->lastCooc[row][col]) {
-            tmpResult->pValue[row][col]++;
-          } else
-          if(graphInfo.originalCooc[row][col] == tmpResult->lastCooc[row][col]){
-            // Pseudo .5/.5 rand. Graphs must be independent, so are these cases
-            // This also ensures exactly equal results for equal rand. seeds
-            tmpResult->pValue[row][col] += (graphIt % 2);
+          localThreadCoocSum += lastCooc[row][col];
+          if ( !settings.incrementalCooc ) {
+            lastCooc[row][col] = 0;
           }
-          localThreadCoocSum += tmpResult->lastCooc[row][col];
-          tmpResult->lastCooc[row][col] = 0;
         }
       }
       // Simple sum reduction is used instead of omp reduction
@@ -279,30 +748,293 @@ bool threadUpdateTmpResult(GRAPH* g, TMPRESULT* tmpResult)
     }
   }
 
+  if ( tmpResult->roundCooc != NULL ) {
+    #pragma omp parallel
+    {
+      OPENMP openMP;
+      threadInit(&openMP);
+
+      #pragma omp for nowait schedule(static) //See threadInit()
+      for (uint firstPairId = 0; firstPairId < graphInfo.nRelevantPairs;
+           firstPairId += STATISTICS_FOLD_CHUNK) {
+        foldRoundStatistics(tmpResult, firstPairId,
+                            min((uint)STATISTICS_FOLD_CHUNK,
+                                graphInfo.nRelevantPairs - firstPairId));
+      }
+
+      threadEnd();
+    }
+  }
+
   return SUCCESS;
 }
 
-void threadDeleteGraph(GRAPH* g)
+bool threadUpdateTmpResultFused(GRAPH* g, TMPRESULT* tmpResult)
 {
+  // Every row of the co-occurrence is accumulated (sparse product engine)
+  //  and folded into the statistics for all graphs in a row, so neither
+  //  the half matrix nor the statistics of the row leave the cache
+  for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+    if ( g[graphIt].eventAccumulatedDegrees[graphInfo.nEvents]
+         != graphInfo.nEdges ) {
+      setEventAccumulatedDegrees( &g[graphIt] ); // First use of this graph
+    }
+  }
+
+  ulint coocSums[settings.nReplicas]; // One per graph
+  memset(coocSums, 0, sizeof coocSums);
+  bool currentStatus = SUCCESS;
   #pragma omp parallel
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    deleteGraph(&g[openMP.threadId]);
+    // Sorted actor lists, and then event-major lists (see threadGetCooc())
+    for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      if ( !g[graphIt].currentEventAdjLists ) {
+        #pragma omp for nowait schedule(auto) //See threadInit()
+        for (uint eventIt=0; eventIt < graphInfo.nEvents; eventIt++) {
+          g[graphIt].eventListsFill[eventIt] =
+              g[graphIt].eventAccumulatedDegrees[eventIt];
+        }
+      }
+      #pragma omp for nowait schedule(auto) //See threadInit()
+      for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+        setIndexesOfSubBlocks( &g[graphIt], actorIt );
+      }
+    }
+
+    threadBarrier();
+
+    for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      if ( !g[graphIt].currentEventAdjLists ) {
+        #pragma omp for nowait schedule(auto) //See threadInit()
+        for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+          transposeActorAdjList( &g[graphIt], actorIt );
+        }
+      }
+
+      // Update position of redundant edges
+      if ( settings.isBipartiteGraph == FALSE ) {
+        #pragma omp for nowait schedule(auto) //See threadInit()
+        for (uint edgeIt = 0; edgeIt < graphInfo.nEdges; ++edgeIt) {
+          if ( currentStatus == SUCCESS ) {
+            g[graphIt].edgeLinks[edgeIt] = findLinkedEgde( &g[graphIt], edgeIt );
+            //Handle reported error through impossible value
+            if ( g[graphIt].edgeLinks[edgeIt] == graphInfo.nEdges ) {
+              currentStatus = FAILURE; // Avoid use of the expensive omp cancel
+            }
+          }
+        }
+      }
+    }
+
+    threadBarrier();
+
+    threadFoldCoocRows(g, tmpResult, coocSums, &currentStatus);
 
     threadEnd();
- }
+  }
+  if ( currentStatus == FAILURE ) { FORWARD_ERROR; } // Catch error
+
+  return threadCheckCoocSums(g, coocSums);
+}
+
+bool threadPrepareCoocRows(GRAPH* g)
+{
+  // The steps of threadUpdateTmpResultFused() before the rows, for one graph
+  //  by the calling thread alone
+  if ( g->eventAccumulatedDegrees[graphInfo.nEvents] != graphInfo.nEdges ) {
+    setEventAccumulatedDegrees( g ); // First use of this graph
+  }
+
+  // Sorted actor lists, and then event-major lists (see threadGetCooc())
+  if ( !g->currentEventAdjLists ) {
+    for (uint eventIt=0; eventIt < graphInfo.nEvents; eventIt++) {
+      g->eventListsFill[eventIt] = g->eventAccumulatedDegrees[eventIt];
+    }
+  }
+  for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+    setIndexesOfSubBlocks( g, actorIt );
+  }
+  if ( !g->currentEventAdjLists ) {
+    for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+      transposeActorAdjList( g, actorIt );
+    }
+  }
+
+  // Update position of redundant edges
+  if ( settings.isBipartiteGraph == FALSE ) {
+    for (uint edgeIt = 0; edgeIt < graphInfo.nEdges; ++edgeIt) {
+      g->edgeLinks[edgeIt] = findLinkedEgde( g, edgeIt );
+      //Handle reported error through impossible value
+      if ( g->edgeLinks[edgeIt] == graphInfo.nEdges ) { return FAILURE; }
+    }
+  }
+
+  return SUCCESS;
+}
+
+void threadFoldCoocRows(GRAPH* g, TMPRESULT* tmpResult, ulint* coocSums,
+                        bool* currentStatus)
+{
+  // Rows of all graphs folded into the statistics, shared among the threads
+  //  of the calling region. The graphs must be prepared by then (see
+  //  threadPrepareCoocRows())
+  const uint threadId = omp_get_thread_num();
+  const uint nThreads = omp_get_num_threads();
+
+  ulint localThreadCoocSums[settings.nReplicas]; // Simple sum reduction
+  memset(localThreadCoocSums, 0, sizeof localThreadCoocSums);
+  // The team size is the same for all threads, so either all of them skip
+  //  the rows or none (see threadAllocScratch())
+  if ( nThreads <= nCoocAccumulators ) {
+    uint* accumulator = coocAccumulators[threadId];
+    // Rows have very different costs: deal them dynamically
+    #pragma omp for nowait schedule(dynamic, 16) //See threadInit()
+    for (uint eventIt=0; eventIt < graphInfo.nEvents - 1; eventIt++) {
+      for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+        accumulateCoocRow( &g[graphIt], eventIt, accumulator );
+        localThreadCoocSums[graphIt] +=
+            foldCoocRowStatistics( tmpResult, eventIt, accumulator, graphIt );
+      }
+      if ( tmpResult->roundCooc != NULL ) {
+        foldRoundStatistics( tmpResult,
+                             graphInfo.relevantPairsRowStart[eventIt],
+                             graphInfo.relevantPairsRowStart[eventIt+1]
+                             - graphInfo.relevantPairsRowStart[eventIt] );
+      }
+    }
+  } else if ( threadId == 0 ) {
+    STDERR_INFO("Unexpected behavior - %u co-occurrence accumulators "
+                "for %u threads.", nCoocAccumulators, nThreads);
+    *currentStatus = FAILURE;
+  }
+
+  // Simple sum reduction is used instead of omp reduction
+  //  to avoid deadlock when running in forced sequential mode
+  for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+    #pragma omp atomic
+    coocSums[graphIt] += localThreadCoocSums[graphIt];
+  }
 }
 
-void threadRandFree(gsl_rng** randG)
+bool threadCheckCoocSums(GRAPH* g, ulint* coocSums)
 {
+  for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+    g[graphIt].sortedActorAdjLists = TRUE;
+    if ( coocSums[graphIt] != graphInfo.coocSum ) {
+      STDERR_INFO("Graph %2u co-occurrence sum  ( %lu ) is "
+                  "different from the expected ( %lu ) !\n",
+                  graphIt,
+                  coocSums[graphIt],
+                  graphInfo.coocSum
+                  );
+      RETURN_ERROR;
+    }
+  }
+
+  return SUCCESS;
+}
+
+bool threadRunSamplingRound(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                            TMPRESULT* tmpResult)
+{
+  // The whole round in one parallel region: each graph is randomized and
+  //  prepared for its rows by whichever thread is free, and the rows of all
+  //  graphs are then folded into the statistics as in
+  //  threadUpdateTmpResultFused(). A single barrier, waiting for the last
+  //  graph, instead of the fork and join of every step
+  omp_lock_t writeStderrLock;
+  omp_init_lock(&writeStderrLock);
+
+  ulint coocSums[settings.nReplicas]; // One per graph
+  memset(coocSums, 0, sizeof coocSums);
+  bool swapStatus = SUCCESS;
+  bool currentStatus = SUCCESS;
   #pragma omp parallel
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    gsl_rng_free(randG[openMP.threadId]);
+    // Every graph has its own random generator and scratch, so the samples
+    //  do not depend on the thread randomizing it
+    #pragma omp for nowait schedule(dynamic, 1) //See threadInit()
+    for ( uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      if ( !settings.isBipartiteGraph ) {
+        threadRunGeneralSwitchesReplica(g, randG, nSwaps, graphIt,
+                                        &writeStderrLock, &swapStatus);
+      } else if ( settings.runCurveball ) {
+        threadRunCurveballReplica(g, randG, nSwaps, graphIt,
+                                  &writeStderrLock, &swapStatus);
+      } else {
+        threadRunBipartiteSwitchesReplica(g, randG, nSwaps, graphIt,
+                                          &writeStderrLock, &swapStatus);
+      }
+      if ( threadPrepareCoocRows( &g[graphIt] ) == FAILURE ) {
+        currentStatus = FAILURE;
+      }
+    }
+
+    threadBarrier();
+
+    threadFoldCoocRows(g, tmpResult, coocSums, &currentStatus);
+
+    threadEnd();
+  }
+  omp_destroy_lock(&writeStderrLock);
+  if ( swapStatus == FAILURE || currentStatus == FAILURE ) { FORWARD_ERROR; }
+
+  return threadCheckCoocSums(g, coocSums);
+}
+
+void threadDeleteGraph(GRAPH* g)
+{
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      deleteGraph(&g[graphIt]);
+    }
+
+    threadEnd();
+ }
+}
+
+void threadFreeScratch()
+{
+  for ( uint threadIt=0; threadIt < nRankThreads(); ++threadIt ) {
+    deleteTradeScratch(&tradeScratch[threadIt]);
+    arenaFree(&scratchArena[threadIt]);
+  }
+  free(tradeScratch);
+  tradeScratch = NULL;
+
+  free(scratchArena);
+  scratchArena = NULL;
+
+  for ( uint threadIt=0; threadIt < nCoocAccumulators; ++threadIt ) {
+    free(coocAccumulators[threadIt]);
+  }
+  free(coocAccumulators);
+  coocAccumulators = NULL;
+  nCoocAccumulators = 0;
+}
+
+void threadRandFree(RANDGEN** randG)
+{
+  #pragma omp parallel num_threads(nRankThreads()) // One stream per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadInit()
+    for (uint threadIt = 0; threadIt < nRankThreads(); threadIt++) {
+      randGenFree(randG[threadIt]);
+    }
 
     threadEnd();
   }
@@ -310,7 +1042,7 @@ void threadRandFree(gsl_rng** randG)
   free(randG);
   randG = NULL;
 
-  gsl_rng_free(randC);
+  randGenFree(randC);
 
 }
 
@@ -318,6 +1050,12 @@ void threadRandFree(gsl_rng** randG)
 // Core functions
 bool threadGetCooc(GRAPH* g, uint** coocs)
 {
+  bool isSpGEMM = ( settings.coocEngine == COOC_ENGINE_SPGEMM );
+  bool isBitMatrix = ( settings.coocEngine == COOC_ENGINE_BITMATRIX );
+  if ( isSpGEMM
+       && g->eventAccumulatedDegrees[graphInfo.nEvents] != graphInfo.nEdges ) {
+    setEventAccumulatedDegrees( g ); // First use of this graph
+  }
 
   bool currentStatus = SUCCESS;
   #pragma omp parallel
@@ -325,12 +1063,26 @@ bool threadGetCooc(GRAPH* g, uint** coocs)
     OPENMP openMP;
     threadInit(&openMP);
 
-    if ( settings.isBipartiteGraph ) {
+    // Event lists left current by event-side trades need no transposition
+    bool needsTranspose = ( isSpGEMM && !g->currentEventAdjLists );
+    if ( needsTranspose ) {
+      #pragma omp for nowait schedule(auto) //See threadInit()
+      for (uint eventIt=0; eventIt < graphInfo.nEvents; eventIt++) {
+        g->eventListsFill[eventIt] = g->eventAccumulatedDegrees[eventIt];
+      }
+    }
+
+    // Actor lists are sorted whatever the engine, so that the randomization
+    //  (which depends on the lists order) gives equal results for equal seeds
+    // Not the ones left behind by event-side trades (bipartite graphs only),
+    //  which nothing reads
+    if ( ( settings.isBipartiteGraph || isSpGEMM || isBitMatrix )
+         && !g->staleActorAdjLists ) {
       #pragma omp for nowait schedule(auto) //See threadInit()
       for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
         setIndexesOfSubBlocks( g, actorIt );
       }
-    } else {
+    } else if ( !settings.isBipartiteGraph && !isSpGEMM && !isBitMatrix ) {
       #pragma omp for nowait schedule(auto) //See threadInit()
       for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
         setIndexesOfSubBlocks( g, actorIt );
@@ -341,7 +1093,59 @@ bool threadGetCooc(GRAPH* g, uint** coocs)
 
     threadBarrier();
 
-    computeCooc( g, coocs, openMP.threadId );
+    if ( isSpGEMM ) {
+      // Event-major lists from the (now sorted) actor lists
+      if ( needsTranspose ) {
+        #pragma omp for nowait schedule(auto) //See threadInit()
+        for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+          transposeActorAdjList( g, actorIt );
+        }
+      }
+
+      threadBarrier();
+
+      // The team size is the same for all threads, so either all of them
+      //  skip the rows or none (see threadAllocScratch())
+      if ( (uint) openMP.nThreads <= nCoocAccumulators ) {
+        uint* accumulator = coocAccumulators[openMP.threadId];
+        // Rows have very different costs: deal them dynamically
+        #pragma omp for nowait schedule(dynamic, 16) //See threadInit()
+        for (uint eventIt=0; eventIt < graphInfo.nEvents - 1; eventIt++) {
+          computeCoocRow( g, coocs, eventIt, accumulator );
+        }
+      } else if ( openMP.threadId == 0 ) {
+        STDERR_INFO("Unexpected behavior - %u co-occurrence accumulators "
+                    "for %u threads.", nCoocAccumulators, openMP.nThreads);
+        currentStatus = FAILURE;
+      }
+
+    } else if ( isBitMatrix ) {
+      // Only the adj. matrix is read
+      // Bands of rows have decreasing costs: deal them dynamically
+      #pragma omp for nowait schedule(dynamic, 1) //See threadInit()
+      for (uint eventIt=0; eventIt < graphInfo.nEvents - 1;
+           eventIt += COOC_BITMATRIX_ROW_TILE) {
+        computeCoocBitMatrixRows( g, coocs, eventIt );
+      }
+
+    } else {
+      // Tiles from the most to the least expensive, dealt dynamically, so
+      //  that any team balances them without changing the schedule
+      #pragma omp for nowait schedule(dynamic, 1) //See threadInit()
+      for (uint tileIt=0; tileIt < coocSchedule.nTiles; tileIt++) {
+        computeCoocTile( g, coocs, coocSchedule.tileOrder[tileIt] );
+      }
+
+      // Heavy actors, once all tiles are done
+      if ( coocSchedule.nHeavyActors > 0 ) {
+        threadBarrier();
+
+        #pragma omp for nowait schedule(dynamic, 1) //See threadInit()
+        for (uint bandIt=0; bandIt < coocSchedule.nHeavyBands; bandIt++) {
+          computeCoocHeavyBand( g, coocs, bandIt );
+        }
+      }
+    }
 
     // Update position of redundant edges
     if ( settings.isBipartiteGraph == FALSE ) {
@@ -360,261 +1164,603 @@ bool threadGetCooc(GRAPH* g, uint** coocs)
     threadEnd();
   }
   if ( currentStatus == FAILURE ) { FORWARD_ERROR; } // Catch error
+  g->sortedActorAdjLists = TRUE;
 
   return SUCCESS;
 }
 
-bool threadRunCurveballBipartite(GRAPH* g, gsl_rng** randG, ulint nSwaps)
+// Trades of one graph by the calling thread (see threadRunCurveballBipartite())
+void threadRunCurveballReplica(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                               uint graphIt, omp_lock_t* writeStderrLock,
+                               bool* returnFlag)
 {
-  omp_lock_t writeStderrLock;
-  omp_init_lock(&writeStderrLock);
-
-  bool returnFlag = SUCCESS;
-  #pragma omp parallel
-  {
-    OPENMP openMP;
-    threadInit(&openMP);
-
-    uint randNumber[2];
-    for (ulint step=0; step < nSwaps; ++step) {
+  // Event-side curveball: the event lists are traded, and the actor lists
+  //  are rebuilt from them once all trades are done, if read before the
+  //  next ones
+  if ( isEventSideCurveball() ) {
+    if ( !g[graphIt].currentEventAdjLists
+         && !g[graphIt].staleActorAdjLists ) {
+      buildEventAdjLists( &g[graphIt] );
+    }
+    g[graphIt].currentEventAdjLists = FALSE;
+  }
 
-      randNumber[0] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nActors);
-      randNumber[1] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nActors);
-      while ( randNumber[1] == randNumber[0] ) {
-        // Force actors to be different
-        randNumber[1] =
-            (uint)gsl_rng_uniform_int(randG[openMP.threadId],graphInfo.nActors);
-      }
-      curveballTradeHashedLists( &g[openMP.threadId],
-                                 randNumber, randG[openMP.threadId]);
+  uint randNumber[2];
+  RANDBATCH actorBatch;
+  randBatchInit(&actorBatch, nTradeLists());
+  for (ulint step=0; step < nSwaps; ++step) {
 
-      #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
-      {
-        char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjMatrixFileName, threadId_str);
-        strcat(adjMatrixFileName, ".dbg");
-        printAdjMatrix(&g[openMP.threadId],  adjMatrixFileName);
-      }
-      #endif
-      #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
-      {
-        char adjListFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjListFileName, threadId_str);
-        strcat(adjListFileName, ".dbg");
-        printActorAdjLists(&g[openMP.threadId], adjListFileName);
-      }
-      #endif
+    randNumber[0] = randBatchNext(randG[graphIt], &actorBatch);
+    randNumber[1] = randBatchNext(randG[graphIt], &actorBatch);
+    while ( randNumber[1] == randNumber[0] ) {
+      // Force actors to be different
+      randNumber[1] = randBatchNext(randG[graphIt], &actorBatch);
+    }
+    if ( curveballTrade( &g[graphIt], randNumber, randG[graphIt],
+                         &tradeScratch[graphIt] ) == FAILURE ) {
+      *returnFlag = FAILURE; // Force end of the swaps of all graphs
+      break;
+    }
 
-      #if TEST_GRAPH_EACH_SWAP
-      {
-        adjMatrixFromAdjListsBipartite( &g[openMP.threadId] );
-        if ( graphTest(&g[openMP.threadId]) == FAILURE )
-        {
-          returnFlag = FAILURE; // Force end of parallel section for all threads
-          omp_set_lock(&writeStderrLock);
-          // Print graph test error in order
-          graphTest(&g[openMP.threadId]);
-          STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
-                      "Last swap tried edges with id's %u and %u.",
-                      openMP.threadId,
-                      randNumber[0], randNumber[1]);
-          omp_unset_lock(&writeStderrLock);
-          break;
-        } else if ( returnFlag == FAILURE )
-        {
-          break;
-        }
-      }
-      #endif
+    #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
+    {
+      char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjMatrixFileName, graphId_str);
+      strcat(adjMatrixFileName, ".dbg");
+      printAdjMatrix(&g[graphIt],  adjMatrixFileName);
+    }
+    #endif
+    #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
+    {
+      char adjListFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjListFileName, graphId_str);
+      strcat(adjListFileName, ".dbg");
+      printActorAdjLists(&g[graphIt], adjListFileName);
     }
+    #endif
 
-    // Re-build adj. matrix - actually not needed for swapping nor for cooc
-    //  currently here for testing the graph
-    adjMatrixFromAdjLists( &g[openMP.threadId] );
-    #if TEST_GRAPH
+    #if TEST_GRAPH_EACH_SWAP
     {
-      if ( graphTest(&g[openMP.threadId]) == FAILURE )
+      if ( isEventSideCurveball() ) {
+        actorAdjListsFromEventAdjLists( &g[graphIt], &scratchArena[graphIt] );
+      }
+      adjMatrixFromAdjListsBipartite( &g[graphIt] );
+      if ( graphTest(&g[graphIt]) == FAILURE )
       {
-        returnFlag = FAILURE; // Force end of parallel section for all threads
-        omp_set_lock(&writeStderrLock);
+        *returnFlag = FAILURE; // Force end of the swaps of all graphs
+        omp_set_lock(writeStderrLock);
         // Print graph test error in order
-        graphTest(&g[openMP.threadId]);
-        STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
-                    "Last swap tried edges of actors with id's %u and %u.",
-                    openMP.threadId,
+        graphTest(&g[graphIt]);
+        STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
+                    "Last swap tried edges with id's %u and %u.",
+                    graphIt,
                     randNumber[0], randNumber[1]);
-        omp_unset_lock(&writeStderrLock);
+        omp_unset_lock(writeStderrLock);
+        break;
+      } else if ( *returnFlag == FAILURE )
+      {
+        break;
       }
     }
     #endif
+  }
 
-    threadEnd();
+  // Incremental co-occurrence: the lists are not sorted by a co-occurrence
+  //  computation, and the trades depend on their order. Sort them here, so
+  //  that equal seeds give equal results in both modes
+  if ( g[graphIt].cooc != NULL ) {
+    for (uint actorIt=0; actorIt < graphInfo.nActors; actorIt++) {
+      setIndexesOfSubBlocks( &g[graphIt], actorIt );
+    }
+    g[graphIt].sortedActorAdjLists = TRUE;
   }
 
-  return returnFlag;
+  // Actor lists (sorted) and edge indexes of the event lists at once, so
+  //  that the co-occurrence engines neither sort nor transpose
+  // Left behind when neither the engine nor the graph test reads them
+  if ( isEventSideCurveball() ) {
+    if ( !needsActorAdjListsAfterTrades()
+         && !( TEST_GRAPH && isFullGraphTestStep( &g[graphIt] ) ) ) {
+      g[graphIt].staleActorAdjLists = TRUE;
+    } else if ( actorAdjListsFromEventAdjLists( &g[graphIt],
+                                                &scratchArena[graphIt] )
+                == FAILURE ) {
+      STDERR_INFO("Graph %u: could not rebuild the actor lists.", graphIt);
+      *returnFlag = FAILURE;
+    }
+  }
+
+  // Re-build adj. matrix - not needed for swapping, but read by the
+  //  bit matrix co-occurrence engine, and by the full graph test
+  bool rebuildStatus = SUCCESS;
+  if ( needsAdjMatrixAfterTrades()
+       || ( TEST_GRAPH && isFullGraphTestStep( &g[graphIt] ) ) ) {
+    rebuildStatus = adjMatrixFromAdjLists( &g[graphIt] );
+  }
+  if ( rebuildStatus == FAILURE ) {
+    *returnFlag = FAILURE; // Force end of the swaps of all graphs
+    omp_set_lock(writeStderrLock);
+    STDERR_INFO("Graph %u: could not rebuild the adj. matrix (or edge set) "
+                "after the trades.", graphIt);
+    omp_unset_lock(writeStderrLock);
+  }
+  #if TEST_GRAPH
+  {
+    if ( rebuildStatus == SUCCESS && graphTestStep(&g[graphIt]) == FAILURE )
+    {
+      *returnFlag = FAILURE; // Force end of the swaps of all graphs
+      omp_set_lock(writeStderrLock);
+      // Print graph test error in order
+      graphTest(&g[graphIt]);
+      STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
+                  "Last swap tried edges of actors with id's %u and %u.",
+                  graphIt,
+                  randNumber[0], randNumber[1]);
+      omp_unset_lock(writeStderrLock);
+    }
+  }
+  #endif
 }
 
-bool threadRunSingleSwitchesBipartite(GRAPH* g, gsl_rng** randG, ulint nSwaps)
+bool threadRunCurveballBipartite(GRAPH* g, RANDGEN** randG, ulint nSwaps)
 {
+  if ( settings.globalCurveball ) {
+    return threadRunGlobalCurveballBipartite(g, randG, nSwaps);
+  }
+
   omp_lock_t writeStderrLock;
   omp_init_lock(&writeStderrLock);
 
   bool returnFlag = SUCCESS;
-  #pragma omp parallel
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    uint randNumber[2];
-    for (ulint swap=0; swap < nSwaps; swap++) {
-      randNumber[0] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nEdges);
-      randNumber[1] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nEdges);
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      threadRunCurveballReplica(g, randG, nSwaps, graphIt,
+                                &writeStderrLock, &returnFlag);
+    }
 
-      singleSwapBipartite( &g[openMP.threadId], randNumber);
+    threadEnd();
+  }
 
-      #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
-      {
-        char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjMatrixFileName, threadId_str);
-        strcat(adjMatrixFileName, ".dbg");
-        printAdjMatrix(&g[openMP.threadId],  adjMatrixFileName);
+  return returnFlag;
+}
+
+bool threadRunGlobalCurveballBipartite(GRAPH* g, RANDGEN** randG, ulint nSwaps)
+{
+  // Global curveball: each round draws a random perfect matching of the
+  //  actors, and its nActors/2 disjoint trades are run concurrently by the
+  //  threads of the graph (see "-threadsperreplica"). The graphs are
+  //  randomized concurrently, each one by its own team of threads
+  // The trades of a round touch disjoint lists, so they need no locking
+  const uint nTradesPerRound = graphInfo.nActors / 2;
+  const ulint nRounds = ( nTradesPerRound == 0 ) ? 0 :
+      ( nSwaps + nTradesPerRound - 1 ) / nTradesPerRound;
+
+  omp_lock_t writeStderrLock;
+  omp_init_lock(&writeStderrLock);
+
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One team per graph
+  {
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      GRAPH* thisG = &g[graphIt];
+
+      // Actors of trade t: matchedActors[2t] and matchedActors[2t+1]
+      uint* matchedActors;
+      arrayCalloc(matchedActors, graphInfo.nActors);
+      if ( matchedActors == NULL ) {
+        STDERR_INFO("Graph %u: could not allocate the actor matching.",
+                    graphIt);
+        returnFlag = FAILURE;
+      } else {
+        for (uint actorIt=0; actorIt < graphInfo.nActors; ++actorIt) {
+          matchedActors[actorIt] = actorIt;
+        }
+
+        #pragma omp parallel num_threads(settings.nThreadsPerReplica)
+        {
+          OPENMP openMP;
+          threadInit(&openMP);
+          // Generator and scratch of this thread among those of the rank
+          const uint rankThreadId =
+              graphIt * settings.nThreadsPerReplica + openMP.threadId;
+
+          // The sorted kernels would sort all lists in their first trade,
+          //  which can not be done by concurrent trades
+          if ( isSortedCurveballKernel() && !thisG->sortedActorAdjLists ) {
+            threadBarrier(); // Every thread has read the flag
+            #pragma omp for nowait schedule(dynamic, 64) //See threadInit()
+            for (uint actorIt=0; actorIt < graphInfo.nActors; ++actorIt) {
+              sortActorAdjList(thisG, actorIt);
+            }
+            threadBarrier();
+            #pragma omp master
+            {
+              thisG->sortedActorAdjLists = TRUE;
+            }
+          }
+
+          for (ulint roundIt=0; roundIt < nRounds; ++roundIt) {
+            // The matching is drawn from the generator of the team master,
+            //  and the trades from the generator of the thread running them
+            #pragma omp master
+            {
+              shuffle(matchedActors, graphInfo.nActors, randG[rankThreadId]);
+            }
+            threadBarrier();
+
+            #pragma omp for nowait schedule(static) //See threadInit()
+            for (uint tradeIt=0; tradeIt < nTradesPerRound; ++tradeIt) {
+              if ( returnFlag == SUCCESS ) {
+                if ( curveballTrade( thisG, &matchedActors[2*tradeIt],
+                                     randG[rankThreadId],
+                                     &tradeScratch[rankThreadId] )
+                     == FAILURE ) {
+                  returnFlag = FAILURE; // Avoid the expensive omp cancel
+                }
+              }
+            }
+            threadBarrier(); // All trades done before the next matching
+
+            #if TEST_GRAPH_EACH_SWAP
+            #pragma omp master
+            {
+              if ( adjMatrixFromAdjLists( thisG ) == FAILURE ) {
+                omp_set_lock(&writeStderrLock);
+                STDERR_INFO("Graph %u: could not rebuild the adj. matrix "
+                            "(or edge set) in global curveball round %lu.",
+                            graphIt, roundIt);
+                omp_unset_lock(&writeStderrLock);
+                returnFlag = FAILURE;
+              } else if ( graphTest(thisG) == FAILURE ) {
+                STDERR_INFO("Unexpected behavior - graph test failed in "
+                            "global curveball round %lu of graph %u.",
+                            roundIt, graphIt);
+                returnFlag = FAILURE;
+              }
+            }
+            threadBarrier();
+            #endif
+          }
+
+          threadEnd();
+        }
       }
-      #endif
-      #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
-      {
-        char adjListFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjListFileName, threadId_str);
-        strcat(adjListFileName, ".dbg");
-        printActorAdjLists(&g[openMP.threadId], adjListFileName);
+      free(matchedActors);
+
+      // Re-build adj. matrix - not needed for swapping, but read by the
+      //  bit matrix co-occurrence engine, and by the full graph test
+      bool rebuildStatus = SUCCESS;
+      if ( needsAdjMatrixAfterTrades()
+           || ( TEST_GRAPH && isFullGraphTestStep(thisG) ) ) {
+        rebuildStatus = adjMatrixFromAdjLists( thisG );
       }
-      #endif
-      #if TEST_GRAPH_EACH_SWAP
+      if ( rebuildStatus == FAILURE ) {
+        returnFlag = FAILURE;
+        omp_set_lock(&writeStderrLock);
+        STDERR_INFO("Graph %u: could not rebuild the adj. matrix (or edge "
+                    "set) after global curveball rounds.", graphIt);
+        omp_unset_lock(&writeStderrLock);
+      }
+      #if TEST_GRAPH
       {
-        if ( graphTest(&g[openMP.threadId]) == FAILURE ) {
-          returnFlag = FAILURE; // Force end of parallel section for all threads
+        if ( rebuildStatus == SUCCESS && graphTestStep(thisG) == FAILURE )
+        {
+          returnFlag = FAILURE;
           omp_set_lock(&writeStderrLock);
-          graphTest(&g[openMP.threadId]);
-          STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
-                      "Last swap tried edges with id's %u and %u.",
-                      openMP.threadId,
-                      randNumber[0], randNumber[1]);
+          STDERR_INFO("Unexpected behavior - graph test failed for graph %u "
+                      "after global curveball rounds.", graphIt);
           omp_unset_lock(&writeStderrLock);
-          break;
-        } else if ( returnFlag == FAILURE ) { break; }
+        }
       }
       #endif
     }
+  }
+  omp_destroy_lock(&writeStderrLock);
+
+  return returnFlag;
+}
 
-    #if TEST_GRAPH
+// Switches of one graph by the calling thread (see
+//  threadRunSingleSwitchesBipartite())
+void threadRunBipartiteSwitchesReplica(GRAPH* g, RANDGEN** randG,
+                                       ulint nSwaps, uint graphIt,
+                                       omp_lock_t* writeStderrLock,
+                                       bool* returnFlag)
+{
+  uint randNumber[2];
+  RANDBATCH edgeBatch;
+  randBatchInit(&edgeBatch, graphInfo.nEdges);
+  // Edges of the next switches, drawn in the same order as if they were
+  //  drawn one switch at a time (see prefetchSwapEdges())
+  uint pipelineEdgeIds[SINGLE_SWITCH_PIPELINE_DEPTH][2];
+  for (ulint swap=0; swap < min(nSwaps, SINGLE_SWITCH_PIPELINE_DEPTH);
+       swap++) {
+    pipelineEdgeIds[swap][0] = randBatchNext(randG[graphIt], &edgeBatch);
+    pipelineEdgeIds[swap][1] = randBatchNext(randG[graphIt], &edgeBatch);
+    prefetchSwapEdges( &g[graphIt], pipelineEdgeIds[swap] );
+  }
+  for (ulint swap=0; swap < nSwaps; swap++) {
+    uint* edgeIds = pipelineEdgeIds[ swap % SINGLE_SWITCH_PIPELINE_DEPTH ];
+    randNumber[0] = edgeIds[0];
+    randNumber[1] = edgeIds[1];
+
+    singleSwapBipartite( &g[graphIt], randNumber);
+
+    // Switches are resolved in order, one at a time: only the memory
+    //  accesses of the next ones are started ahead
+    if ( swap + SINGLE_SWITCH_PIPELINE_DEPTH < nSwaps ) {
+      edgeIds[0] = randBatchNext(randG[graphIt], &edgeBatch);
+      edgeIds[1] = randBatchNext(randG[graphIt], &edgeBatch);
+      prefetchSwapEdges( &g[graphIt], edgeIds );
+    }
+    if ( swap + SINGLE_SWITCH_PIPELINE_DEPTH/2 < nSwaps ) {
+      prefetchSwapLookups( &g[graphIt],
+          pipelineEdgeIds[ (swap + SINGLE_SWITCH_PIPELINE_DEPTH/2)
+                           % SINGLE_SWITCH_PIPELINE_DEPTH ] );
+    }
+
+    #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
     {
-      if ( graphTest(&g[openMP.threadId]) == FAILURE ) {
-        returnFlag = FAILURE; // Force end of parallel section for all threads
-        omp_set_lock(&writeStderrLock);
-        graphTest(&g[openMP.threadId]);
-        STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
+      char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjMatrixFileName, graphId_str);
+      strcat(adjMatrixFileName, ".dbg");
+      printAdjMatrix(&g[graphIt],  adjMatrixFileName);
+    }
+    #endif
+    #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
+    {
+      char adjListFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjListFileName, graphId_str);
+      strcat(adjListFileName, ".dbg");
+      printActorAdjLists(&g[graphIt], adjListFileName);
+    }
+    #endif
+    #if TEST_GRAPH_EACH_SWAP
+    {
+      if ( graphTest(&g[graphIt]) == FAILURE ) {
+        *returnFlag = FAILURE; // Force end of the swaps of all graphs
+        omp_set_lock(writeStderrLock);
+        graphTest(&g[graphIt]);
+        STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
                     "Last swap tried edges with id's %u and %u.",
-                    openMP.threadId,
+                    graphIt,
                     randNumber[0], randNumber[1]);
-        omp_unset_lock(&writeStderrLock);
-      }
+        omp_unset_lock(writeStderrLock);
+        break;
+      } else if ( *returnFlag == FAILURE ) { break; }
     }
     #endif
-
-    threadEnd();
   }
 
-  return returnFlag;
+  #if TEST_GRAPH
+  {
+    if ( graphTestStep(&g[graphIt]) == FAILURE ) {
+      *returnFlag = FAILURE; // Force end of the swaps of all graphs
+      omp_set_lock(writeStderrLock);
+      graphTest(&g[graphIt]);
+      STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
+                  "Last swap tried edges with id's %u and %u.",
+                  graphIt,
+                  randNumber[0], randNumber[1]);
+      omp_unset_lock(writeStderrLock);
+    }
+  }
+  #endif
 }
 
-bool threadRunSingleSwitchesGeneral(GRAPH* g, gsl_rng** randG, ulint nSwaps)
+bool threadRunSingleSwitchesBipartite(GRAPH* g, RANDGEN** randG, ulint nSwaps)
 {
+  if ( settings.globalSingleSwitch ) {
+    return threadRunGlobalSingleSwitchesBipartite(g, randG, nSwaps);
+  }
+
   omp_lock_t writeStderrLock;
   omp_init_lock(&writeStderrLock);
 
   bool returnFlag = SUCCESS;
-  #pragma omp parallel
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
   {
     OPENMP openMP;
     threadInit(&openMP);
 
-    uint randNumber[2];
-    for (ulint swap=0; swap < nSwaps; swap++) {
-      randNumber[0] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nEdges);
-      randNumber[1] =
-          (uint) gsl_rng_uniform_int(randG[openMP.threadId], graphInfo.nEdges);
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      threadRunBipartiteSwitchesReplica(g, randG, nSwaps, graphIt,
+                                        &writeStderrLock, &returnFlag);
+    }
+
+    threadEnd();
+  }
 
-      singleSwapGeneral( &g[openMP.threadId], randNumber);
+  return returnFlag;
+}
 
-      #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
-      {
-        char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjMatrixFileName, threadId_str);
-        strcat(adjMatrixFileName, ".dbg");
-        printAdjMatrix(&g[openMP.threadId],  adjMatrixFileName);
+bool threadRunGlobalSingleSwitchesBipartite(GRAPH* g, RANDGEN** randG,
+                                            ulint nSwaps)
+{
+  // Global single switches: the nSwaps switches of a graph are split among
+  //  the threads of the graph (see "-threadsperreplica"), which run them
+  //  concurrently (see trySingleSwapParallel()). The graphs are randomized
+  //  concurrently, each one by its own team of threads
+  if ( graphInfo.nEvents > SWAP_ENTRY_LOCK_BIT ) {
+    STDERR_INFO("Too many events (%u) for global single switches.",
+                graphInfo.nEvents);
+    RETURN_ERROR;
+  }
+
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One team per graph
+  {
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      if ( nSwaps > 0 ) {
+        g[graphIt].sortedActorAdjLists = FALSE;
       }
-      #endif
-      #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
+
+      #pragma omp parallel num_threads(settings.nThreadsPerReplica)
       {
-        char adjListFileName[30 + MAX_INT_STR_SIZE];
-        strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
-        char threadId_str[MAX_INT_STR_SIZE];
-        sprintf(threadId_str, "%u", openMP.threadId);
-        strcat(adjListFileName, threadId_str);
-        strcat(adjListFileName, ".dbg");
-        printActorAdjLists(&g[openMP.threadId], adjListFileName);
+        OPENMP openMP;
+        threadInit(&openMP);
+        // Generator of this thread among those of the rank
+        const uint rankThreadId =
+            graphIt * settings.nThreadsPerReplica + openMP.threadId;
+
+        uint randNumber[2];
+        RANDBATCH edgeBatch;
+        randBatchInit(&edgeBatch, graphInfo.nEdges);
+        #pragma omp for nowait schedule(static) //See threadInit()
+        for (ulint swap=0; swap < nSwaps; swap++) {
+          // Switches given up on a concurrent one are drawn again
+          do {
+            randNumber[0] = randBatchNext(randG[rankThreadId], &edgeBatch);
+            randNumber[1] = randBatchNext(randG[rankThreadId], &edgeBatch);
+          } while ( !trySingleSwapParallel( &g[graphIt], randNumber) );
+        }
+
+        threadEnd();
       }
-      #endif
-      #if TEST_GRAPH_EACH_SWAP
+
+      #if TEST_GRAPH
+      if ( graphTestStep(&g[graphIt]) == FAILURE )
       {
-        if ( graphTest(&g[openMP.threadId]) == FAILURE) {
-          returnFlag = FAILURE; // Force end of parallel section for all threads
-          omp_set_lock(&writeStderrLock);
-          graphTest(&g[openMP.threadId]);
-          STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
-                      "Last swap tried edges with id's %u and %u.",
-                      openMP.threadId,
-                      randNumber[0], randNumber[1]);
-          omp_unset_lock(&writeStderrLock);
-          break;
-        } else if ( returnFlag == FAILURE ) { break; }
+        returnFlag = FAILURE;
+        STDERR_INFO("Unexpected behavior - graph test failed for graph %u "
+                    "after global single switches.", graphIt);
       }
       #endif
     }
+  }
+
+  return returnFlag;
+}
+
+// Switches of one graph by the calling thread (see
+//  threadRunSingleSwitchesGeneral())
+void threadRunGeneralSwitchesReplica(GRAPH* g, RANDGEN** randG, ulint nSwaps,
+                                     uint graphIt, omp_lock_t* writeStderrLock,
+                                     bool* returnFlag)
+{
+  uint randNumber[2];
+  RANDBATCH edgeBatch;
+  randBatchInit(&edgeBatch, graphInfo.nEdges);
+  // Edges of the next switches, drawn in the same order as if they were
+  //  drawn one switch at a time (see prefetchSwapEdges())
+  uint pipelineEdgeIds[SINGLE_SWITCH_PIPELINE_DEPTH][2];
+  for (ulint swap=0; swap < min(nSwaps, SINGLE_SWITCH_PIPELINE_DEPTH);
+       swap++) {
+    pipelineEdgeIds[swap][0] = randBatchNext(randG[graphIt], &edgeBatch);
+    pipelineEdgeIds[swap][1] = randBatchNext(randG[graphIt], &edgeBatch);
+    prefetchSwapEdges( &g[graphIt], pipelineEdgeIds[swap] );
+  }
+  for (ulint swap=0; swap < nSwaps; swap++) {
+    uint* edgeIds = pipelineEdgeIds[ swap % SINGLE_SWITCH_PIPELINE_DEPTH ];
+    randNumber[0] = edgeIds[0];
+    randNumber[1] = edgeIds[1];
+
+    singleSwapGeneral( &g[graphIt], randNumber);
+
+    // Switches are resolved in order, one at a time: only the memory
+    //  accesses of the next ones are started ahead
+    if ( swap + SINGLE_SWITCH_PIPELINE_DEPTH < nSwaps ) {
+      edgeIds[0] = randBatchNext(randG[graphIt], &edgeBatch);
+      edgeIds[1] = randBatchNext(randG[graphIt], &edgeBatch);
+      prefetchSwapEdges( &g[graphIt], edgeIds );
+    }
+    if ( swap + SINGLE_SWITCH_PIPELINE_DEPTH/2 < nSwaps ) {
+      prefetchSwapLookups( &g[graphIt],
+          pipelineEdgeIds[ (swap + SINGLE_SWITCH_PIPELINE_DEPTH/2)
+                           % SINGLE_SWITCH_PIPELINE_DEPTH ] );
+    }
 
-    #if TEST_GRAPH
+    #if PRINT_GRAPH_AS_ADJACENCY_MATRIX_EACH_SWAP
     {
-      if ( graphTest(&g[openMP.threadId]) == FAILURE) {
-        returnFlag = FAILURE; // Force end of parallel section for all threads
-        omp_set_lock(&writeStderrLock);
-        graphTest(&g[openMP.threadId]);
-        STDERR_INFO("Unexpected behavior - graph test failed in thread %u.\n"
+      char adjMatrixFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjMatrixFileName, SAMPLES_ADJACENCY_MATRICES_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjMatrixFileName, graphId_str);
+      strcat(adjMatrixFileName, ".dbg");
+      printAdjMatrix(&g[graphIt],  adjMatrixFileName);
+    }
+    #endif
+    #if PRINT_GRAPH_AS_ACTOR_ADJACENCY_LIST_EACH_SWAP
+    {
+      char adjListFileName[30 + MAX_INT_STR_SIZE];
+      strcpy(adjListFileName, SWAPS_ADJACENCY_LISTS_FILE_NAME);
+      char graphId_str[MAX_INT_STR_SIZE];
+      sprintf(graphId_str, "%u", graphIt);
+      strcat(adjListFileName, graphId_str);
+      strcat(adjListFileName, ".dbg");
+      printActorAdjLists(&g[graphIt], adjListFileName);
+    }
+    #endif
+    #if TEST_GRAPH_EACH_SWAP
+    {
+      if ( graphTest(&g[graphIt]) == FAILURE) {
+        *returnFlag = FAILURE; // Force end of the swaps of all graphs
+        omp_set_lock(writeStderrLock);
+        graphTest(&g[graphIt]);
+        STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
                     "Last swap tried edges with id's %u and %u.",
-                    openMP.threadId,
+                    graphIt,
                     randNumber[0], randNumber[1]);
-        omp_unset_lock(&writeStderrLock);
-      }
+        omp_unset_lock(writeStderrLock);
+        break;
+      } else if ( *returnFlag == FAILURE ) { break; }
     }
     #endif
+  }
+
+  #if TEST_GRAPH
+  {
+    if ( graphTestStep(&g[graphIt]) == FAILURE) {
+      *returnFlag = FAILURE; // Force end of the swaps of all graphs
+      omp_set_lock(writeStderrLock);
+      graphTest(&g[graphIt]);
+      STDERR_INFO("Unexpected behavior - graph test failed for graph %u.\n"
+                  "Last swap tried edges with id's %u and %u.",
+                  graphIt,
+                  randNumber[0], randNumber[1]);
+      omp_unset_lock(writeStderrLock);
+    }
+  }
+  #endif
+}
+
+bool threadRunSingleSwitchesGeneral(GRAPH* g, RANDGEN** randG, ulint nSwaps)
+{
+  omp_lock_t writeStderrLock;
+  omp_init_lock(&writeStderrLock);
+
+  bool returnFlag = SUCCESS;
+  #pragma omp parallel num_threads(settings.nReplicas) // One graph per thread
+  {
+    OPENMP openMP;
+    threadInit(&openMP);
+
+    #pragma omp for nowait schedule(static, 1) //See threadCopyGraph()
+    for (uint graphIt = 0; graphIt < settings.nReplicas; graphIt++) {
+      threadRunGeneralSwitchesReplica(g, randG, nSwaps, graphIt,
+                                      &writeStderrLock, &returnFlag);
+    }
 
     threadEnd();
   }
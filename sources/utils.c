@@ -65,6 +65,32 @@ float getCurrentRSS()
   return (float)((size_t)rss * (size_t)sysconf( _SC_PAGESIZE)) / 1024 / 1024 / 1024;
 }
 
+/**
+ * Returns the physical memory available to new allocations measured
+ * in bytes, or zero if the value cannot be determined.
+ * Counts the page cache that can be reclaimed (MemAvailable), if known.
+ */
+size_t getAvailableMemory()
+{
+  size_t availableKb = 0;
+  FILE* fp = NULL;
+  if ( (fp = fopen( "/proc/meminfo", "r" )) != NULL )
+  {
+    char line[256];
+    while ( fgets( line, sizeof line, fp ) != NULL ) {
+      if ( sscanf( line, "MemAvailable: %zu kB", &availableKb ) == 1 ) {
+        break;
+      }
+    }
+    fclose( fp );
+  }
+  if ( availableKb > 0 ) { return availableKb * 1024; }
+
+  long nPages = sysconf( _SC_AVPHYS_PAGES );
+  if ( nPages <= 0 ) { return 0; }     /* Unknown */
+  return (size_t)nPages * (size_t)sysconf( _SC_PAGESIZE );
+}
+
 BLOCK checkBitOnBlockArray(BLOCK* blockArray, size_t bitIndex, size_t blockOffset)
 {
   return ( blockArray[ blockOffset + bitIndex / BITS_PER_BLOCK ]
@@ -86,6 +112,28 @@ void clearBitOnBlockArray(BLOCK* blockArray, size_t bitIndex, size_t blockOffset
   );
 }
 
+// As setBitOnBlockArray(), for blocks shared by threads. Returns whether
+//  the bit was already set, i.e. claimed by another thread
+BLOCK atomicSetBitOnBlockArray(BLOCK* blockArray, size_t bitIndex,
+                               size_t blockOffset)
+{
+  BLOCK* block = &blockArray[ blockOffset + bitIndex / BITS_PER_BLOCK ];
+  const BLOCK mask = (BLOCK)1 << (bitIndex % BITS_PER_BLOCK);
+  BLOCK oldBlock;
+  #pragma omp atomic capture
+  { oldBlock = *block; *block |= mask; }
+  return oldBlock & mask;
+}
+
+void atomicClearBitOnBlockArray(BLOCK* blockArray, size_t bitIndex,
+                                size_t blockOffset)
+{
+  BLOCK* block = &blockArray[ blockOffset + bitIndex / BITS_PER_BLOCK ];
+  const BLOCK mask = ~((BLOCK)1 << (bitIndex % BITS_PER_BLOCK));
+  #pragma omp atomic
+  *block &= mask;
+}
+
 uint popCount(BLOCK _block)
 {
 // Options of bit counters are abundant and data dependent
@@ -148,3 +196,63 @@ char *getFilenameExt(const char *filename) {
   }
   return dot; // Return pointer to the last '.' occurrence
 }
+
+bool arenaReserve(SCRATCHARENA* arena, size_t capacity)
+{
+  // Grows the arena to at least @capacity bytes, which is only allowed
+  //  while none of it is in use, since its arrays would move
+  if ( capacity <= arena->capacity ) { return SUCCESS; }
+  if ( arena->used != 0 ) {
+    STDERR_INFO("Unable to grow a scratch arena while %zu of its %zu bytes "
+                "are in use.", arena->used, arena->capacity);
+    RETURN_ERROR;
+  }
+  capacity = arenaArraySize(char, capacity);
+  char* base = aligned_alloc(ARENA_ALIGNMENT, capacity);
+  if ( base == NULL ) { MEM_ERROR; }
+  free(arena->base);
+  arena->base = base;
+  arena->capacity = capacity;
+  return SUCCESS;
+}
+
+void arenaFree(SCRATCHARENA* arena)
+{
+  free(arena->base);
+  arena->base = NULL;
+  arena->capacity = 0;
+  arena->used = 0;
+}
+
+// Arena of the uthash tables of the calling thread (see setUthashArena())
+static SCRATCHARENA* uthashArena = NULL;
+#pragma omp threadprivate(uthashArena)
+
+void setUthashArena(SCRATCHARENA* arena)
+{
+  uthashArena = arena;
+}
+
+void* uthashArenaMalloc(size_t size)
+{
+  // The allocator serves the tables made without an arena, or larger than
+  //  what is left of it
+  void* pointer = NULL;
+  if ( uthashArena != NULL ) {
+    pointer = arenaPush(uthashArena, size);
+  }
+  if ( pointer == NULL ) {
+    pointer = malloc(size);
+  }
+  return pointer;
+}
+
+void uthashArenaFree(void* pointer)
+{
+  // Memory of the arena is given back with it (see arenaRelease())
+  if (    uthashArena != NULL && (char*)pointer >= uthashArena->base
+       && (char*)pointer < uthashArena->base + uthashArena->capacity ) {
+    return;
+  }
+  free(pointer);
+}